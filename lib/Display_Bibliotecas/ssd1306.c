@@ -1,8 +1,10 @@
 #include "ssd1306.h"
 #include "font.h"
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #include "hardware/i2c.h"
+#include "memoria_estatica.h"
 
 // Inicializa a estrutura do display SSD1306
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c) {
@@ -13,12 +15,13 @@ void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_v
     ssd->i2c_port = i2c;
     ssd->bufsize = ssd->pages * ssd->width + 1;
     
-    // Aloca buffer de dados
-    ssd->ram_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
+    // Aloca buffer de dados da arena estática (feito uma vez, nunca liberado)
+    ssd->ram_buffer = arena_alocar(ssd->bufsize);
     if (ssd->ram_buffer == NULL) {
-        // Em caso de falha, poderia adicionar tratamento de erro (ex.: log ou loop infinito)
+        // Arena pequena demais para o display: aumente MEMORIA_ARENA_BYTES
         while (1);
     }
+    memset(ssd->ram_buffer, 0, ssd->bufsize);
     
     // Inicializa buffers
     ssd->ram_buffer[0] = 0x40; // Prefixo de dados
@@ -5649,10 +5649,157 @@ FRESULT f_expand (
 	LEAVE_FF(fs, res);
 }
 
+
+
+
+/*-----------------------------------------------------------------------*/
+/* Allocate a Contiguous Block Starting on an Alignment Boundary         */
+/*-----------------------------------------------------------------------*/
+/* Same as f_expand(fp, fsz, 1), but the block starts on a multiple of   */
+/* align sectors, such as the erase block (allocation unit) of an SD     */
+/* card. FR_DENIED when no aligned contiguous free block is found.       */
+
+FRESULT f_expand_aligned (
+	FIL* fp,		/* Pointer to the file object */
+	FSIZE_t fsz,	/* File size to be expanded to */
+	DWORD align		/* Alignment of the first sector (a multiple of the cluster size) */
+)
+{
+	FRESULT res;
+	FATFS *fs;
+	DWORD n, clst, scl, tcl, acl, ofs, ncand, lclst;
+
+
+	res = validate(&fp->obj, &fs);		/* Check validity of the file object */
+	if (res != FR_OK || (res = (FRESULT)fp->err) != FR_OK) LEAVE_FF(fs, res);
+	if (fsz == 0 || fp->obj.objsize != 0 || !(fp->flag & FA_WRITE)) LEAVE_FF(fs, FR_DENIED);
+#if FF_FS_EXFAT
+	if (fs->fs_type != FS_EXFAT && fsz >= 0x100000000) LEAVE_FF(fs, FR_DENIED);	/* Check if in size limit */
+#endif
+	if (align == 0 || align % fs->csize != 0) LEAVE_FF(fs, FR_INVALID_PARAMETER);
+	if (fs->database % fs->csize != 0) LEAVE_FF(fs, FR_DENIED);	/* No cluster can be aligned */
+	n = (DWORD)fs->csize * SS(fs);	/* Cluster size */
+	tcl = (DWORD)(fsz / n) + ((fsz & (n - 1)) ? 1 : 0);	/* Number of clusters required */
+	acl = align / fs->csize;		/* Clusters per alignment unit */
+	ofs = (acl - (DWORD)(fs->database / fs->csize % acl)) % acl;	/* Cluster 2 + ofs is the first aligned one */
+	scl = fs->last_clst;
+	if (scl < 2 + ofs || scl >= fs->n_fatent) scl = 2 + ofs;
+	scl = 2 + ofs + (scl - 2 - ofs + acl - 1) / acl * acl;	/* First aligned cluster from the suggested point */
+
+	for (ncand = (fs->n_fatent - 2) / acl + 2; ; ) {	/* Try each aligned cluster until a free block starts there */
+		if (ncand-- == 0) {
+			res = FR_DENIED; break;
+		}
+		if (scl >= fs->n_fatent || tcl > fs->n_fatent - scl) {	/* Wrap-around */
+			scl = 2 + ofs; continue;
+		}
+#if FF_FS_EXFAT
+		if (fs->fs_type == FS_EXFAT) {
+			clst = find_bitmap(fs, scl, tcl);		/* First free block from the candidate */
+			if (clst == 0) {
+				res = FR_DENIED; break;
+			}
+			if (clst == 0xFFFFFFFF) {
+				res = FR_DISK_ERR; break;
+			}
+			if (clst == scl) break;					/* The free block starts on the candidate */
+			if (clst < scl) scl = 2 + ofs;			/* Found after a wrap-around */
+			if (clst > scl) scl += (clst - scl + acl - 1) / acl * acl;	/* First aligned cluster in the free block */
+			continue;
+		} else
+#endif
+		{
+			for (clst = scl; clst < scl + tcl; clst++) {	/* Check that the block is free */
+				n = get_fat(&fp->obj, clst);
+				if (n != 0) break;
+			}
+			if (n == 1) {
+				res = FR_INT_ERR; break;
+			}
+			if (n == 0xFFFFFFFF) {
+				res = FR_DISK_ERR; break;
+			}
+			if (clst == scl + tcl) break;			/* All clusters are free */
+		}
+		scl += ((clst - scl) / acl + 1) * acl;		/* Next aligned cluster after the one in use */
+	}
+
+	if (res == FR_OK) {	/* An aligned contiguous free area is found, allocate it */
+#if FF_FS_EXFAT
+		if (fs->fs_type == FS_EXFAT) {
+			res = change_bitmap(fs, scl, tcl, 1);	/* Mark the cluster block 'in use' */
+			lclst = scl + tcl - 1;
+		} else
+#endif
+		{
+			for (clst = scl, n = tcl, lclst = 0; n; clst++, n--) {	/* Create a cluster chain on the FAT */
+				res = put_fat(fs, clst, (n == 1) ? 0xFFFFFFFF : clst + 1);
+				if (res != FR_OK) break;
+				lclst = clst;
+			}
+		}
+	}
+
+	if (res == FR_OK) {
+		fs->last_clst = lclst;		/* Set suggested start cluster to start next */
+		fp->obj.sclust = scl;		/* Update object allocation information */
+		fp->obj.objsize = fsz;
+		if (FF_FS_EXFAT) fp->obj.stat = 2;	/* Set status 'contiguous chain' */
+		fp->flag |= FA_MODIFIED;
+		if (fs->free_clst <= fs->n_fatent - 2) {	/* Update FSINFO */
+			fs->free_clst -= tcl;
+			fs->fsi_flag |= 1;
+		}
+	}
+
+	LEAVE_FF(fs, res);
+}
+
 #endif /* FF_USE_EXPAND && !FF_FS_READONLY */
 
 
 
+#if FF_USE_TRIM && FF_USE_EXPAND && !FF_FS_READONLY
+/*-----------------------------------------------------------------------*/
+/* Trim Sectors of a Contiguous File                                     */
+/*-----------------------------------------------------------------------*/
+/* The file must be contiguous, as left by f_expand(fp, fsz, 1). Unlike  */
+/* calling disk_ioctl(CTRL_TRIM) directly, this holds the volume lock.   */
+
+FRESULT f_trim (
+	FIL* fp,		/* Pointer to the file object */
+	FSIZE_t ofs,	/* Offset of the first byte to be trimmed (sector aligned) */
+	FSIZE_t len		/* Number of bytes to be trimmed (multiple of the sector size) */
+)
+{
+	FRESULT res;
+	FATFS *fs;
+	LBA_t rt[2];
+
+
+	res = validate(&fp->obj, &fs);		/* Check validity of the file object */
+	if (res != FR_OK || (res = (FRESULT)fp->err) != FR_OK) LEAVE_FF(fs, res);
+	if (!(fp->flag & FA_WRITE)) LEAVE_FF(fs, FR_DENIED);
+	if (len == 0 || ofs % SS(fs) != 0 || len % SS(fs) != 0 || fp->obj.sclust == 0 || ofs + len >= fp->obj.objsize + SS(fs)) {	/* Every sector must hold part of the file */
+		LEAVE_FF(fs, FR_INVALID_PARAMETER);
+	}
+	rt[0] = clst2sect(fs, fp->obj.sclust) + (LBA_t)(ofs / SS(fs));
+	rt[1] = rt[0] + (LBA_t)(len / SS(fs)) - 1;
+#if !FF_FS_TINY
+	if (fp->sect >= rt[0] && fp->sect <= rt[1]) {	/* The buffered sector is discarded as well */
+		fp->flag &= (BYTE)~FA_DIRTY;
+		fp->sect = 0;
+	}
+#endif
+	if (disk_ioctl(fs->pdrv, CTRL_TRIM, rt) != RES_OK) res = FR_DISK_ERR;
+
+	LEAVE_FF(fs, res);
+}
+
+#endif /* FF_USE_TRIM && FF_USE_EXPAND && !FF_FS_READONLY */
+
+
+
 #if FF_USE_FORWARD
 /*-----------------------------------------------------------------------*/
 /* Forward Data to the Stream Directly                                   */
@@ -11,14 +11,22 @@
 /* Allocate/Free a Memory Block                                           */
 /*------------------------------------------------------------------------*/
 
-#include <stdlib.h>		/* with POSIX API */
+/* The LFN working buffers come from a static pool of fixed size blocks, so
+/  they take constant time and cannot fragment the heap on long runs. Larger
+/  requests fail: f_mkfs() then needs a work buffer from the caller.
+*/
+
+#include "memoria_estatica.h"
+
+_Static_assert(MEMORIA_POOL_TAMANHO_BLOCO >= (FF_MAX_LFN + 1) * 2 + (FF_FS_EXFAT ? (FF_MAX_LFN + 44) / 15 * 32 : 0),
+	"MEMORIA_POOL_TAMANHO_BLOCO is too small for the LFN working buffer");
 
 
 void* ff_memalloc (	/* Returns pointer to the allocated memory block (null if not enough core) */
 	UINT msize		/* Number of bytes to allocate */
 )
 {
-	return malloc((size_t)msize);	/* Allocate a new memory block */
+	return pool_alocar((size_t)msize);	/* Allocate a new memory block */
 }
 
 
@@ -26,7 +34,7 @@ void ff_memfree (
 	void* mblock	/* Pointer to the memory block to free (no effect if null) */
 )
 {
-	free(mblock);	/* Free the memory block */
+	pool_liberar(mblock);	/* Free the memory block */
 }
 
 #endif
@@ -39,7 +47,9 @@ void ff_memfree (
 /* Definitions of Mutex                                                   */
 /*------------------------------------------------------------------------*/
 
-#define OS_TYPE	0	/* 0:Win32, 1:uITRON4.0, 2:uC/OS-II, 3:FreeRTOS, 4:CMSIS-RTOS */
+#ifndef OS_TYPE
+#define OS_TYPE	5	/* 0:Win32, 1:uITRON4.0, 2:uC/OS-II, 3:FreeRTOS, 4:CMSIS-RTOS, 5:pico-sdk, 6:POSIX threads */
+#endif
 
 
 #if   OS_TYPE == 0	/* Win32 */
@@ -64,6 +74,67 @@ static SemaphoreHandle_t Mutex[FF_VOLUMES + 1];	/* Table of mutex handle */
 #include "cmsis_os.h"
 static osMutexId Mutex[FF_VOLUMES + 1];	/* Table of mutex ID */
 
+#elif OS_TYPE == 5	/* pico-sdk: mutex_t works across both cores, FF_FS_TIMEOUT is in ms */
+#include "pico/mutex.h"
+#include "pico/time.h"
+static mutex_t Mutex[FF_VOLUMES + 1];	/* Table of mutex */
+
+#elif OS_TYPE == 6	/* POSIX threads: host build of the same hooks, FF_FS_TIMEOUT is in ms */
+#include <pthread.h>
+#include <time.h>
+static pthread_mutex_t Mutex[FF_VOLUMES + 1];	/* Table of mutex */
+
+static uint64_t time_us_64 (void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+#endif
+
+
+#if OS_TYPE >= 5
+/*------------------------------------------------------------------------*/
+/* Contention Counters                                                    */
+/*------------------------------------------------------------------------*/
+/* A take first tries the mutex without waiting, so it is known whether
+/  another core or thread was holding the volume. The counters are updated
+/  while the mutex is held, except for timeouts.
+*/
+
+#include <string.h>
+#include "ff_mutex_stats.h"
+
+static ff_mutex_stats_t Stats[FF_VOLUMES + 1];	/* Table of counters */
+
+
+static void stats_taken (
+	int vol,			/* Mutex ID */
+	int contended,		/* The mutex was held by someone else */
+	uint64_t wait_us	/* Time spent waiting for it */
+)
+{
+	ff_mutex_stats_t *st = &Stats[vol];
+
+	st->takes++;
+	if (contended) {
+		st->contended++;
+		st->total_wait_us += wait_us;
+		if (wait_us > st->max_wait_us) st->max_wait_us = (uint32_t)wait_us;
+	}
+}
+
+
+void ff_mutex_get_stats (
+	int vol,				/* Mutex ID: Volume mutex (0 to FF_VOLUMES - 1) or system mutex (FF_VOLUMES) */
+	ff_mutex_stats_t *stats	/* Receives a copy of the counters */
+)
+{
+	*stats = Stats[vol];
+}
+
 #endif
 
 
@@ -106,6 +177,15 @@ int ff_mutex_create (	/* Returns 1:Function succeeded or 0:Could not create the
 	Mutex[vol] = osMutexCreate(osMutex(cmsis_os_mutex));
 	return (int)(Mutex[vol] != NULL);
 
+#elif OS_TYPE == 5	/* pico-sdk */
+	mutex_init(&Mutex[vol]);
+	memset(&Stats[vol], 0, sizeof Stats[vol]);
+	return 1;
+
+#elif OS_TYPE == 6	/* POSIX threads */
+	memset(&Stats[vol], 0, sizeof Stats[vol]);
+	return (int)(pthread_mutex_init(&Mutex[vol], NULL) == 0);
+
 #endif
 }
 
@@ -138,6 +218,12 @@ void ff_mutex_delete (	/* Returns 1:Function succeeded or 0:Could not delete due
 #elif OS_TYPE == 4	/* CMSIS-RTOS */
 	osMutexDelete(Mutex[vol]);
 
+#elif OS_TYPE == 5	/* pico-sdk */
+	(void)vol;	/* Nothing to release, mutex_init() claims no resources */
+
+#elif OS_TYPE == 6	/* POSIX threads */
+	pthread_mutex_destroy(&Mutex[vol]);
+
 #endif
 }
 
@@ -171,6 +257,44 @@ int ff_mutex_take (	/* Returns 1:Succeeded or 0:Timeout */
 #elif OS_TYPE == 4	/* CMSIS-RTOS */
 	return (int)(osMutexWait(Mutex[vol], FF_FS_TIMEOUT) == osOK);
 
+#elif OS_TYPE == 5	/* pico-sdk */
+	uint64_t start;
+
+	if (mutex_try_enter(&Mutex[vol], NULL)) {
+		stats_taken(vol, 0, 0);
+		return 1;
+	}
+	start = time_us_64();
+	if (!mutex_enter_timeout_ms(&Mutex[vol], FF_FS_TIMEOUT)) {
+		Stats[vol].timeouts++;
+		return 0;
+	}
+	stats_taken(vol, 1, time_us_64() - start);
+	return 1;
+
+#elif OS_TYPE == 6	/* POSIX threads */
+	uint64_t start;
+	struct timespec deadline;
+
+	if (pthread_mutex_trylock(&Mutex[vol]) == 0) {
+		stats_taken(vol, 0, 0);
+		return 1;
+	}
+	start = time_us_64();
+	clock_gettime(CLOCK_REALTIME, &deadline);
+	deadline.tv_sec += FF_FS_TIMEOUT / 1000;
+	deadline.tv_nsec += (long)(FF_FS_TIMEOUT % 1000) * 1000000;
+	if (deadline.tv_nsec >= 1000000000) {
+		deadline.tv_sec++;
+		deadline.tv_nsec -= 1000000000;
+	}
+	if (pthread_mutex_timedlock(&Mutex[vol], &deadline) != 0) {
+		Stats[vol].timeouts++;
+		return 0;
+	}
+	stats_taken(vol, 1, time_us_64() - start);
+	return 1;
+
 #endif
 }
 
@@ -201,6 +325,12 @@ void ff_mutex_give (
 #elif OS_TYPE == 4	/* CMSIS-RTOS */
 	osMutexRelease(Mutex[vol]);
 
+#elif OS_TYPE == 5	/* pico-sdk */
+	mutex_exit(&Mutex[vol]);
+
+#elif OS_TYPE == 6	/* POSIX threads */
+	pthread_mutex_unlock(&Mutex[vol]);
+
 #endif
 }
 
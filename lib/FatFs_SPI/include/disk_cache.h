@@ -0,0 +1,25 @@
+#ifndef DISK_CACHE_H
+#define DISK_CACHE_H
+
+// Sector caches in the diskio glue (glue.c)
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint32_t read_hits;     // Single-sector reads served from a cache
+    uint32_t read_misses;   // Single-sector reads that went to the card
+    uint32_t writes;        // Sectors written by FatFs
+    uint32_t device_writes; // Write transactions issued to the card
+} disk_cache_stats_t;
+
+void disk_cache_get_stats(disk_cache_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // DISK_CACHE_H
@@ -0,0 +1,26 @@
+#ifndef FF_MUTEX_STATS_H
+#define FF_MUTEX_STATS_H
+
+// Contention on the FatFs volume mutexes (ffsystem.c, FF_FS_REENTRANT)
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    uint32_t takes;          // Times the mutex was taken
+    uint32_t contended;      // Takes that found it held and had to wait
+    uint32_t timeouts;       // Takes that gave up after FF_FS_TIMEOUT
+    uint32_t max_wait_us;    // Longest wait
+    uint64_t total_wait_us;  // Sum of all waits
+} ff_mutex_stats_t;
+
+// vol: volume number, or FF_VOLUMES for the system mutex used by FF_FS_LOCK
+void ff_mutex_get_stats(int vol, ff_mutex_stats_t *stats);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // FF_MUTEX_STATS_H
@@ -294,10 +294,7 @@ typedef enum {
 
 #define SPI_CMD(x) (0x40 | (x & 0x3f))
 
-static uint8_t sd_cmd_spi(sd_card_t *pSD, cmdSupported cmd, uint32_t arg) {
-    uint8_t response;
-    char cmdPacket[PACKET_SIZE];
-
+static void sd_cmd_packet(cmdSupported cmd, uint32_t arg, char cmdPacket[PACKET_SIZE]) {
     // Prepare the command packet
     cmdPacket[0] = SPI_CMD(cmd);
     cmdPacket[1] = (arg >> 24);
@@ -325,27 +322,107 @@ static uint8_t sd_cmd_spi(sd_card_t *pSD, cmdSupported cmd, uint32_t arg) {
                 break;
         }
     }
-    // send a command
-    for (int i = 0; i < PACKET_SIZE; i++) {
-        sd_spi_write(pSD, cmdPacket[i]);
+}
+
+#define SD_NCR_MAX 8 /*!< Command response time (NCR), in bytes, for SDC */
+
+// Number of response bytes following R1
+static size_t sd_cmd_trailer_size(cmdSupported cmd) {
+    switch (cmd) {
+        case CMD8_SEND_IF_COND:  // Response R7
+        case CMD58_READ_OCR:     // Response R3
+            return R3_R7_RESPONSE_SIZE - R1_RESPONSE_SIZE;
+        case CMD13_SEND_STATUS:  // Response R2
+            return R2_RESPONSE_SIZE - R1_RESPONSE_SIZE;
+        default:  // Response R1, R1b
+            return 0;
+    }
+}
+
+// True for commands answered with a data block: clocking on after R1 could
+// swallow its start token, which may follow R1 by a single byte.
+static bool sd_cmd_reads_data(cmdSupported cmd) {
+    switch (cmd) {
+        case CMD9_SEND_CSD:
+        case CMD10_SEND_CID:
+        case CMD17_READ_SINGLE_BLOCK:
+        case CMD18_READ_MULTIPLE_BLOCK:
+        case ACMD13_SD_STATUS:
+        case ACMD22_SEND_NUM_WR_BLOCKS:
+        case ACMD51_SEND_SCR:
+            return true;
+        default:
+            return false;
     }
+}
+
+/* Sends a command and receives its response in a single transfer: the
+ * packet is followed by enough fill bytes to cover NCR and the bytes
+ * trailing R1 (R2, R3, R7), and the received buffer is scanned for R1.
+ * Commands answered with a data block only get the minimum NCR of one byte;
+ * should R1 come later, the remaining bytes are polled singly.
+ * The trailing bytes are returned, big-endian, in *trailer (if not NULL).
+ * With `polled`, the FIFO is polled whatever SPI_POLLED_MAX is, as the
+ * asynchronous engine needs in its IRQ.
+ */
+static uint8_t sd_cmd_spi_xfer(sd_card_t *pSD, cmdSupported cmd, uint32_t arg,
+                               uint32_t *trailer, bool polled) {
+    uint8_t tx[PACKET_SIZE + 1 + SD_NCR_MAX + R3_R7_RESPONSE_SIZE];
+    uint8_t rx[sizeof tx];
+    uint8_t response = R1_NO_RESPONSE;
+    size_t trailer_size = sd_cmd_trailer_size(cmd);
+    size_t start = PACKET_SIZE;
+
+    sd_cmd_packet(cmd, arg, (char *)tx);
     // The received byte immediataly following CMD12 is a stuff byte,
     // it should be discarded before receive the response of the CMD12.
     if (CMD12_STOP_TRANSMISSION == cmd) {
-        sd_spi_write(pSD, SPI_FILL_CHAR);
+        ++start;
     }
-    // Loop for response: Response is sent back within command response time
+    size_t length = start + (sd_cmd_reads_data(cmd)
+                                 ? R1_RESPONSE_SIZE
+                                 : SD_NCR_MAX + R1_RESPONSE_SIZE + trailer_size);
+    memset(tx + PACKET_SIZE, SPI_FILL_CHAR, length - PACKET_SIZE);
+    if (polled)
+        spi_transfer_polled(pSD->spi, tx, rx, length);
+    else
+        sd_spi_transfer(pSD, tx, rx, length);
+
+    // Look for the response: it is sent back within command response time
     // (NCR), 0 to 8 bytes for SDC
-    for (int i = 0; i < 0x10; i++) {
-        response = sd_spi_write(pSD, SPI_FILL_CHAR);
-        // Got the response
-        if (!(response & R1_RESPONSE_RECV)) {
-            break;
+    size_t i = start;
+    while (i < length && (rx[i] & R1_RESPONSE_RECV)) ++i;
+    if (i < length) {
+        response = rx[i++];
+    } else {
+        for (size_t n = length - start; n < 0x10; n++) {
+            response = polled ? spi_xchg(pSD->spi, SPI_FILL_CHAR)
+                              : sd_spi_write(pSD, SPI_FILL_CHAR);
+            // Got the response
+            if (!(response & R1_RESPONSE_RECV)) {
+                break;
+            }
         }
     }
+    // The bytes after R1: those already received, then the rest
+    uint32_t rest = 0;
+    for (size_t n = 0; n < trailer_size; n++) {
+        rest <<= 8;
+        if (i < length)
+            rest |= rx[i++];
+        else
+            rest |= polled ? spi_xchg(pSD->spi, SPI_FILL_CHAR)
+                           : sd_spi_write(pSD, SPI_FILL_CHAR);
+    }
+    if (trailer) *trailer = rest;
     return response;
 }
 
+static uint8_t sd_cmd_spi(sd_card_t *pSD, cmdSupported cmd, uint32_t arg,
+                          uint32_t *trailer) {
+    return sd_cmd_spi_xfer(pSD, cmd, arg, trailer, false);
+}
+
 static bool sd_wait_ready(sd_card_t *pSD, int timeout) {
     char resp;
 
@@ -363,10 +440,18 @@ static bool sd_wait_ready(sd_card_t *pSD, int timeout) {
     return (resp > 0x00);
 }
 
+#if SD_ASYNC_WRITE_ENABLED
+static void sd_write_async_drain(sd_card_t *pSD);
+#endif
+
 // An SD card can only do one thing at a time.
 static void sd_lock(sd_card_t *pSD) {
     myASSERT(mutex_is_initialized(&pSD->mutex));
     mutex_enter_blocking(&pSD->mutex);
+#if SD_ASYNC_WRITE_ENABLED
+    // Queued asynchronous writes go out before anything else uses the card
+    sd_write_async_drain(pSD);
+#endif
 }
 static void sd_unlock(sd_card_t *pSD) {
     myASSERT(mutex_is_initialized(&pSD->mutex));
@@ -456,6 +541,7 @@ static int sd_cmd(sd_card_t *pSD, const cmdSupported cmd, uint32_t arg,
 
     int32_t status = SD_BLOCK_DEVICE_ERROR_NONE;
     uint32_t response;
+    uint32_t trailer = 0;
 
     // No need to wait for card to be ready when sending the stop command
     if (CMD12_STOP_TRANSMISSION != cmd) {
@@ -467,14 +553,14 @@ static int sd_cmd(sd_card_t *pSD, const cmdSupported cmd, uint32_t arg,
     for (int i = 0; i < SD_COMMAND_RETRIES; i++) {
         // Send CMD55 for APP command first
         if (isAcmd) {
-            response = sd_cmd_spi(pSD, CMD55_APP_CMD, 0x0);
+            response = sd_cmd_spi(pSD, CMD55_APP_CMD, 0x0, NULL);
             // Wait for card to be ready after CMD55
             if (false == sd_wait_ready(pSD, SD_COMMAND_TIMEOUT)) {
                 DBG_PRINTF("%s:%d: Card not ready yet\r\n", __FILE__, __LINE__);
             }
         }
         // Send command over SPI interface
-        response = sd_cmd_spi(pSD, cmd, arg);
+        response = sd_cmd_spi(pSD, cmd, arg, &trailer);
         if (R1_NO_RESPONSE == response) {
             DBG_PRINTF("No response CMD:%d\r\n", cmd);
             continue;
@@ -524,10 +610,8 @@ static int sd_cmd(sd_card_t *pSD, const cmdSupported cmd, uint32_t arg,
             pSD->card_type = SDCARD_V2;  // fallthrough
             // Note: No break here, need to read rest of the response
         case CMD58_READ_OCR:  // Response R3
-            response = (sd_spi_write(pSD, SPI_FILL_CHAR) << 24);
-            response |= (sd_spi_write(pSD, SPI_FILL_CHAR) << 16);
-            response |= (sd_spi_write(pSD, SPI_FILL_CHAR) << 8);
-            response |= sd_spi_write(pSD, SPI_FILL_CHAR);
+            // Received along with R1 by sd_cmd_spi()
+            response = trailer;
             DBG_PRINTF("R3/R7: 0x%" PRIx32 "\r\n", response);
             break;
         case CMD12_STOP_TRANSMISSION:  // Response R1b
@@ -536,7 +620,7 @@ static int sd_cmd(sd_card_t *pSD, const cmdSupported cmd, uint32_t arg,
             break;
         case CMD13_SEND_STATUS:  // Response R2
             response <<= 8;
-            response |= sd_spi_write(pSD, SPI_FILL_CHAR);
+            response |= trailer;
             if (response) {
                 DBG_PRINTF("R2: 0x%" PRIx32 "\r\n", response);
                 if (response & 0x01 << 0) {
@@ -682,12 +766,13 @@ static int sd_cmd8(sd_card_t *pSD) {
     return status;
 }
 
-static uint32_t ext_bits(unsigned char *data, int msb, int lsb) {
+// Extracts bits [msb:lsb] of a register sent MSB first in `length` bytes
+static uint32_t ext_bits_n(unsigned char *data, size_t length, int msb, int lsb) {
     uint32_t bits = 0;
     uint32_t size = 1 + msb - lsb;
     for (uint32_t i = 0; i < size; i++) {
         uint32_t position = lsb + i;
-        uint32_t byte = 15 - (position >> 3);
+        uint32_t byte = length - 1 - (position >> 3);
         uint32_t bit = position & 0x7;
         uint32_t value = (data[byte] >> bit) & 1;
         bits |= value << i;
@@ -695,6 +780,11 @@ static uint32_t ext_bits(unsigned char *data, int msb, int lsb) {
     return bits;
 }
 
+// Extracts bits [msb:lsb] of a 128-bit register (CSD, CID)
+static uint32_t ext_bits(unsigned char *data, int msb, int lsb) {
+    return ext_bits_n(data, 16, msb, lsb);
+}
+
 static int sd_read_bytes(sd_card_t *pSD, uint8_t *buffer, uint32_t length);
 
 static uint64_t sd_sectors_nolock(sd_card_t *pSD) {
@@ -713,6 +803,10 @@ static uint64_t sd_sectors_nolock(sd_card_t *pSD) {
         DBG_PRINTF("Couldn't read csd response from disk\r\n");
         return 0;
     }
+    // Erase sector size: (SECTOR_SIZE + 1) write blocks
+    // sector_size : csd[45:39], write_bl_len : csd[25:22]
+    pSD->erase_sectors = ((ext_bits(csd, 45, 39) + 1) << ext_bits(csd, 25, 22)) /
+                         _block_size;
     // csd_structure : csd[127:126]
     int csd_structure = ext_bits(csd, 127, 126);
     switch (csd_structure) {
@@ -752,6 +846,35 @@ static uint64_t sd_sectors_nolock(sd_card_t *pSD) {
     };
     return blocks;
 }
+// Allocation unit sizes, in 512-byte sectors, indexed by AU_SIZE
+static const uint32_t sd_au_sectors[16] = {
+    0,     32,    64,    128,   256,   512,   1024,  2048,
+    4096,  8192,  16384, 24576, 32768, 49152, 65536, 131072};
+
+/* Reads the 512-bit SD Status register (ACMD13, data block after an R2
+ * response) for the allocation unit size and speed class. The AU is the
+ * unit the card's write performance is specified in: sequential writes
+ * that fill whole AUs keep the card in its fast path. */
+static int sd_read_sd_status(sd_card_t *pSD) {
+    uint8_t status[64];
+    int err = sd_cmd(pSD, ACMD13_SD_STATUS, 0x0, true, 0);
+    if (SD_BLOCK_DEVICE_ERROR_NONE == err) err = sd_read_bytes(pSD, status, sizeof status);
+    if (SD_BLOCK_DEVICE_ERROR_NONE != err) {
+        DBG_PRINTF("Couldn't read SD Status\r\n");
+        return err;
+    }
+    static const uint8_t speed_classes[] = {0, 2, 4, 6, 10};
+    uint32_t speed_class = ext_bits_n(status, sizeof status, 447, 440);  // SPEED_CLASS
+    pSD->speed_class =
+        speed_class < count_of(speed_classes) ? speed_classes[speed_class] : 0;
+    uint32_t au_size = ext_bits_n(status, sizeof status, 431, 428);      // AU_SIZE
+    if (!au_size) au_size = ext_bits_n(status, sizeof status, 395, 392); // UHS_AU_SIZE
+    pSD->au_sectors = sd_au_sectors[au_size];
+    DBG_PRINTF("SD Status: AU %" PRIu32 " sectors, speed class %u\r\n",
+               pSD->au_sectors, pSD->speed_class);
+    return SD_BLOCK_DEVICE_ERROR_NONE;
+}
+
 uint64_t sd_sectors(sd_card_t *pSD) {
     sd_acquire(pSD);
     uint64_t sectors = sd_sectors_nolock(pSD);
@@ -777,21 +900,25 @@ static bool sd_wait_token(sd_card_t *pSD, uint8_t token) {
 #define SPI_START_BLOCK \
     (0xFE) /*!< For Single Block Read/Write and Multiple Block Read */
 
+#define SD_READ_BYTES_MAX 64 /*!< Longest register read: the SD Status */
+
+// Reads a short data block (a register) and its CRC16 in one transfer
 static int sd_read_bytes(sd_card_t *pSD, uint8_t *buffer, uint32_t length) {
+    uint8_t received[SD_READ_BYTES_MAX + 2];
     uint16_t crc;
 
+    if (length > SD_READ_BYTES_MAX) return SD_BLOCK_DEVICE_ERROR_PARAMETER;
     // read until start byte (0xFE)
     if (false == sd_wait_token(pSD, SPI_START_BLOCK)) {
         DBG_PRINTF("%s:%d Read timeout\r\n", __FILE__, __LINE__);
         return SD_BLOCK_DEVICE_ERROR_NO_RESPONSE;
     }
-    // read data
-    for (uint32_t i = 0; i < length; i++) {
-        buffer[i] = sd_spi_write(pSD, SPI_FILL_CHAR);
+    // read data and the CRC16 checksum after it
+    if (!sd_spi_transfer(pSD, NULL, received, length + 2)) {
+        return SD_BLOCK_DEVICE_ERROR_NO_RESPONSE;
     }
-    // Read the CRC16 checksum for the data block
-    crc = (sd_spi_write(pSD, SPI_FILL_CHAR) << 8);
-    crc |= sd_spi_write(pSD, SPI_FILL_CHAR);
+    memcpy(buffer, received, length);
+    crc = (received[length] << 8) | received[length + 1];
 
 #if SD_CRC_ENABLED
     if (crc_on) {
@@ -809,7 +936,28 @@ static int sd_read_bytes(sd_card_t *pSD, uint8_t *buffer, uint32_t length) {
 
     return 0;
 }
+// Waits for a transfer started by spi_transfer_start_rx_tail*(), which only
+// spi_transfer_is_busy() sees finish; on a timeout the channels are stopped
+static bool sd_wait_rx_tail(sd_card_t *pSD) {
+    absolute_time_t timeout_time = make_timeout_time_ms(1000);
+    while (spi_transfer_is_busy(pSD->spi)) {
+        if (time_reached(timeout_time)) {
+            DBG_PRINTF("%s: DMA timed out\r\n", __FUNCTION__);
+            dma_channel_abort(pSD->spi->rx_tail_dma);
+            dma_channel_abort(pSD->spi->rx_dma);
+            dma_channel_abort(pSD->spi->tx_dma);
+#if SD_CRC_ENABLED
+            spi_transfer_get_crc16(pSD->spi);
+#endif
+            return false;
+        }
+        tight_loop_contents();
+    }
+    return true;
+}
+
 static int sd_read_block(sd_card_t *pSD, uint8_t *buffer, uint32_t length) {
+    uint8_t crc_bytes[2];
     uint16_t crc;
 
     // read until start byte (0xFE)
@@ -817,24 +965,30 @@ static int sd_read_block(sd_card_t *pSD, uint8_t *buffer, uint32_t length) {
         DBG_PRINTF("%s:%d Read timeout\r\n", __FILE__, __LINE__);
         return SD_BLOCK_DEVICE_ERROR_NO_RESPONSE;
     }
-    // read data
-    // bool spi_transfer(const uint8_t *tx, uint8_t *rx, size_t length)
-    if (!sd_spi_transfer(pSD, NULL, buffer, length)) {
+    // read data and, chained in the same transfer, the CRC16 checksum
+#if SD_CRC_ENABLED
+    // The DMA sniffer computes the checksum while the data comes in
+    spi_transfer_start_rx_tail_crc16(pSD->spi, buffer, length, crc_bytes,
+                                     sizeof crc_bytes, 0);
+#else
+    spi_transfer_start_rx_tail(pSD->spi, buffer, length, crc_bytes,
+                               sizeof crc_bytes);
+#endif
+    if (!sd_wait_rx_tail(pSD)) {
         return SD_BLOCK_DEVICE_ERROR_NO_RESPONSE;
     }
-    // Read the CRC16 checksum for the data block
-    crc = (sd_spi_write(pSD, SPI_FILL_CHAR) << 8);
-    crc |= sd_spi_write(pSD, SPI_FILL_CHAR);
+#if SD_CRC_ENABLED
+    uint16_t crc_result = spi_transfer_get_crc16(pSD->spi);
+#endif
+    crc = (crc_bytes[0] << 8) | crc_bytes[1];
 
 #if SD_CRC_ENABLED
     if (crc_on) {
-        uint32_t crc_result;
-        // Compute and verify checksum
-        crc_result = crc16((void *)buffer, length);
-        if ((uint16_t)crc_result != crc) {
+        // Verify checksum
+        if (crc_result != crc) {
             DBG_PRINTF("%s: Invalid CRC received 0x%" PRIx16
                        " result of computation 0x%" PRIx16 "\r\n",
-                       __FUNCTION__, crc, (uint16_t)crc_result);
+                       __FUNCTION__, crc, crc_result);
             return SD_BLOCK_DEVICE_ERROR_CRC;
         }
     }
@@ -843,6 +997,123 @@ static int sd_read_block(sd_card_t *pSD, uint8_t *buffer, uint32_t length) {
     return SD_BLOCK_DEVICE_ERROR_NONE;
 }
 
+/* Multi-block read pipeline
+ * -------------------------
+ * After CMD18 the card streams blocks, each one a start token after some
+ * NAC fill bytes, 512 data bytes and a CRC16. Rather than polling for the
+ * token, DMAing the data and polling the CRC per block, each DMA receives
+ * the rest of a block, its CRC and SD_READ_PREFETCH further bytes in one
+ * chained transfer. The next start token is usually within the prefetch;
+ * any data bytes after it go to the start of the next block and the CRC
+ * sniffer resumes from their CRC. Each block's CRC is checked while the
+ * DMA for the next one is running.
+ */
+#define SD_READ_PREFETCH 8 /*!< Bytes received after each block's CRC */
+
+static int sd_read_blocks_pipelined(sd_card_t *pSD, uint8_t *buffer,
+                                    uint32_t blockCnt) {
+    uint8_t tail[2 + SD_READ_PREFETCH];
+    size_t have = 0;  // Bytes of the current block already received
+    bool pending = false;
+    uint16_t pending_crc = 0, pending_result = 0;
+
+    // read until start byte (0xFE)
+    if (false == sd_wait_token(pSD, SPI_START_BLOCK)) {
+        DBG_PRINTF("%s:%d Read timeout\r\n", __FILE__, __LINE__);
+        return SD_BLOCK_DEVICE_ERROR_NO_RESPONSE;
+    }
+    for (uint32_t n = 0; n < blockCnt; ++n) {
+        uint8_t *block = buffer + n * _block_size;
+        bool last = (n + 1 == blockCnt);
+        // CMD12 follows the last block: nothing to prefetch
+        size_t tail_length = 2 + (last ? 0 : SD_READ_PREFETCH);
+
+#if SD_CRC_ENABLED
+        unsigned short seed = 0;
+        update_crc16(&seed, (const char *)block, have);
+        spi_transfer_start_rx_tail_crc16(pSD->spi, block + have, _block_size - have,
+                                         tail, tail_length, seed);
+#else
+        spi_transfer_start_rx_tail(pSD->spi, block + have, _block_size - have,
+                                   tail, tail_length);
+#endif
+#if SD_CRC_ENABLED
+        // Meanwhile, verify the previous block
+        if (pending && crc_on && pending_crc != pending_result) {
+            DBG_PRINTF("%s: Invalid CRC received 0x%" PRIx16
+                       " result of computation 0x%" PRIx16 "\r\n",
+                       __FUNCTION__, pending_crc, pending_result);
+            while (spi_transfer_is_busy(pSD->spi)) tight_loop_contents();
+            spi_transfer_get_crc16(pSD->spi);
+            return SD_BLOCK_DEVICE_ERROR_CRC;
+        }
+#endif
+        if (!sd_wait_rx_tail(pSD)) {
+            return SD_BLOCK_DEVICE_ERROR_NO_RESPONSE;
+        }
+#if SD_CRC_ENABLED
+        pending_result = spi_transfer_get_crc16(pSD->spi);
+#endif
+        pending_crc = (tail[0] << 8) | tail[1];
+        pending = true;
+        if (last) break;
+
+        // Look for the next start token in the prefetched bytes
+        size_t i = 2;
+        while (i < tail_length && SPI_FILL_CHAR == tail[i]) ++i;
+        if (i == tail_length) {
+            have = 0;
+            if (false == sd_wait_token(pSD, SPI_START_BLOCK)) {
+                DBG_PRINTF("%s:%d Read timeout\r\n", __FILE__, __LINE__);
+                return SD_BLOCK_DEVICE_ERROR_NO_RESPONSE;
+            }
+        } else if (SPI_START_BLOCK == tail[i]) {
+            ++i;
+            have = tail_length - i;
+            memcpy(block + _block_size, tail + i, have);
+        } else {
+            DBG_PRINTF("%s: Data error token 0x%02x\r\n", __FUNCTION__, tail[i]);
+            return SD_BLOCK_DEVICE_ERROR_NO_RESPONSE;
+        }
+    }
+#if SD_CRC_ENABLED
+    if (crc_on && pending_crc != pending_result) {
+        DBG_PRINTF("%s: Invalid CRC received 0x%" PRIx16
+                   " result of computation 0x%" PRIx16 "\r\n",
+                   __FUNCTION__, pending_crc, pending_result);
+        return SD_BLOCK_DEVICE_ERROR_CRC;
+    }
+#endif
+    return SD_BLOCK_DEVICE_ERROR_NONE;
+}
+
+/* SCK rates tried by sd_negotiate_baud(), slowest first. The first entry is
+ * the initialization rate, which sd_init_medium() has already proven.
+ * spi_set_baudrate() rounds each down to what clk_peri can divide to.
+ */
+#ifndef SD_BAUD_PROBE
+#define SD_BAUD_PROBE SD_CRC_ENABLED
+#endif
+#if SD_BAUD_PROBE && !SD_CRC_ENABLED
+#error "SD_BAUD_PROBE needs SD_CRC_ENABLED: the probe relies on read CRCs"
+#endif
+static const uint sd_baud_steps[] = {400 * 1000,   1000 * 1000,
+                                     5000 * 1000,  10000 * 1000,
+                                     12500 * 1000, 16667 * 1000,
+                                     25000 * 1000};
+#define SD_BAUD_STEPS (sizeof sd_baud_steps / sizeof sd_baud_steps[0])
+
+// Falls back to the next slower rate; false if already at the slowest
+static bool sd_baud_step_down(sd_card_t *pSD) {
+    if (0 == pSD->baud_step) return false;
+    --pSD->baud_step;
+    pSD->baud_rate = sd_baud_steps[pSD->baud_step];
+    ++pSD->baud_fallbacks;
+    sd_spi_go_high_frequency(pSD);
+    DBG_PRINTF("%s: SCK lowered to %u Hz\r\n", __FUNCTION__, pSD->baud_rate);
+    return true;
+}
+
 static int in_sd_read_blocks(sd_card_t *pSD, uint8_t *buffer,
                              uint64_t ulSectorNumber, uint32_t ulSectorCount) {
     uint32_t blockCnt = ulSectorCount;
@@ -873,9 +1144,16 @@ static int in_sd_read_blocks(sd_card_t *pSD, uint8_t *buffer,
     }
     // receive the data : one block at a time
     int rd_status = 0;
+    if (blockCnt > 1) {
+        rd_status = sd_read_blocks_pipelined(pSD, buffer, blockCnt);
+        blockCnt = 0;
+    }
     while (blockCnt) {
-        if (0 != sd_read_block(pSD, buffer, _block_size)) {
-            rd_status = SD_BLOCK_DEVICE_ERROR_NO_RESPONSE;
+        rd_status = sd_read_block(pSD, buffer, _block_size);
+        if (0 != rd_status) {
+            // Keep CRC errors distinct: they trigger the SCK fallback
+            if (SD_BLOCK_DEVICE_ERROR_CRC != rd_status)
+                rd_status = SD_BLOCK_DEVICE_ERROR_NO_RESPONSE;
             break;
         }
         buffer += _block_size;
@@ -894,6 +1172,9 @@ int sd_read_blocks(sd_card_t *pSD, uint8_t *buffer, uint64_t ulSectorNumber,
     TRACE_PRINTF("sd_read_blocks(0x%p, 0x%llx, 0x%lx)\r\n", buffer,
                  ulSectorNumber, ulSectorCount);
     int status = in_sd_read_blocks(pSD, buffer, ulSectorNumber, ulSectorCount);
+    // Signal integrity problems at high SCK rates show up as CRC errors
+    while (SD_BLOCK_DEVICE_ERROR_CRC == status && sd_baud_step_down(pSD))
+        status = in_sd_read_blocks(pSD, buffer, ulSectorNumber, ulSectorCount);
     sd_release(pSD);
     return status;
 }
@@ -907,22 +1188,24 @@ static uint8_t sd_write_block(sd_card_t *pSD, const uint8_t *buffer,
     sd_spi_write(pSD, token);
 
     // write the data
-    bool ret = sd_spi_transfer(pSD, buffer, NULL, length);
-    myASSERT(ret);
-
 #if SD_CRC_ENABLED
+    // The DMA sniffer computes the CRC while the data goes out
+    uint16_t crc_result;
+    bool ret = sd_spi_transfer_crc16(pSD, buffer, NULL, length, &crc_result);
+    myASSERT(ret);
     if (crc_on) {
-        // Compute CRC
-        crc = crc16((void *)buffer, length);
+        crc = crc_result;
     }
+#else
+    bool ret = sd_spi_transfer(pSD, buffer, NULL, length);
+    myASSERT(ret);
 #endif
 
-    // write the checksum CRC16
-    sd_spi_write(pSD, crc >> 8);
-    sd_spi_write(pSD, crc);
-
-    // check the response token
-    response = sd_spi_write(pSD, SPI_FILL_CHAR);
+    // write the checksum CRC16 and clock in the response token
+    uint8_t trailer_tx[3] = {crc >> 8, crc, SPI_FILL_CHAR};
+    uint8_t trailer_rx[3];
+    sd_spi_transfer(pSD, trailer_tx, trailer_rx, sizeof trailer_tx);
+    response = trailer_rx[2];
 
     // Wait for last block to be written
     if (false == sd_wait_ready(pSD, SD_COMMAND_TIMEOUT)) {
@@ -977,7 +1260,8 @@ static int in_sd_write_blocks(sd_card_t *pSD, const uint8_t *buffer,
         // Only CRC and general write error are communicated via response token
         if (response != SPI_DATA_ACCEPTED) {
             DBG_PRINTF("Single Block Write failed: 0x%x \r\n", response);
-            status = SD_BLOCK_DEVICE_ERROR_WRITE;
+            status = (SPI_DATA_CRC_ERROR == response) ? SD_BLOCK_DEVICE_ERROR_CRC
+                                                      : SD_BLOCK_DEVICE_ERROR_WRITE;
         }
     } else {
         // Pre-erase setting prior to multiple block write operation
@@ -996,7 +1280,9 @@ static int in_sd_write_blocks(sd_card_t *pSD, const uint8_t *buffer,
             response = sd_write_block(pSD, buffer, SPI_START_BLK_MUL_WRITE, _block_size);
             if (response != SPI_DATA_ACCEPTED) {
                 DBG_PRINTF("Multiple Block Write failed: 0x%x\r\n", response);
-                status = SD_BLOCK_DEVICE_ERROR_WRITE;
+                status = (SPI_DATA_CRC_ERROR == response)
+                             ? SD_BLOCK_DEVICE_ERROR_CRC
+                             : SD_BLOCK_DEVICE_ERROR_WRITE;
                 break;
             }
             buffer += _block_size;
@@ -1010,8 +1296,8 @@ static int in_sd_write_blocks(sd_card_t *pSD, const uint8_t *buffer,
     uint32_t stat = 0;
     // Some SD cards want to be deselected between every bus transaction:
     sd_spi_deselect_pulse(pSD);
-    status = sd_cmd(pSD, CMD13_SEND_STATUS, 0, false, &stat);
-    return status;
+    int st_status = sd_cmd(pSD, CMD13_SEND_STATUS, 0, false, &stat);
+    return status ? status : st_status;
 }
 
 int sd_write_blocks(sd_card_t *pSD, const uint8_t *buffer,
@@ -1020,10 +1306,505 @@ int sd_write_blocks(sd_card_t *pSD, const uint8_t *buffer,
     TRACE_PRINTF("sd_write_blocks(0x%p, 0x%llx, 0x%lx)\r\n", buffer,
                  ulSectorNumber, blockCnt);
     int status = in_sd_write_blocks(pSD, buffer, ulSectorNumber, blockCnt);
+    // The card rejected the data CRC: slow down and send it again
+    while (SD_BLOCK_DEVICE_ERROR_CRC == status && sd_baud_step_down(pSD))
+        status = in_sd_write_blocks(pSD, buffer, ulSectorNumber, blockCnt);
+    sd_release(pSD);
+    return status;
+}
+
+#define SD_ERASE_TIMEOUT_PER_MB 250 /*!< Busy time allowed per MB erased, in ms */
+
+/* Erases a range of blocks (CMD32, CMD33, CMD38). Erased blocks read back as
+ * all 0s or all 1s, depending on the card, and writing into them later spares
+ * the card an erase of its own, which shortens its busy time after writes. */
+int sd_erase_blocks(sd_card_t *pSD, uint64_t ulSectorNumber, uint32_t blockCnt) {
+    if (!blockCnt) return SD_BLOCK_DEVICE_ERROR_NONE;
+    sd_acquire(pSD);
+    TRACE_PRINTF("sd_erase_blocks(0x%llx, 0x%lx)\r\n", ulSectorNumber, blockCnt);
+
+    int status = SD_BLOCK_DEVICE_ERROR_NONE;
+    if (ulSectorNumber + blockCnt > pSD->sectors ||
+        pSD->m_Status & (STA_NOINIT | STA_NODISK)) {
+        status = SD_BLOCK_DEVICE_ERROR_PARAMETER;
+    }
+    // SDSC Card (CCS=0) uses byte unit address
+    uint64_t start = ulSectorNumber, end = ulSectorNumber + blockCnt - 1;
+    if (SDCARD_V2HC != pSD->card_type) {
+        start *= _block_size;
+        end *= _block_size;
+    }
+    if (SD_BLOCK_DEVICE_ERROR_NONE == status)
+        status = sd_cmd(pSD, CMD32_ERASE_WR_BLK_START_ADDR, start, false, 0);
+    if (SD_BLOCK_DEVICE_ERROR_NONE == status)
+        status = sd_cmd(pSD, CMD33_ERASE_WR_BLK_END_ADDR, end, false, 0);
+    if (SD_BLOCK_DEVICE_ERROR_NONE == status) {
+        status = sd_cmd(pSD, CMD38_ERASE, 0x0, false, 0);
+        // sd_cmd() only waits SD_COMMAND_TIMEOUT: large ranges take longer
+        uint32_t timeout = SD_COMMAND_TIMEOUT + (blockCnt / 2048 + 1) * SD_ERASE_TIMEOUT_PER_MB;
+        if (SD_BLOCK_DEVICE_ERROR_NONE == status && !sd_wait_ready(pSD, timeout)) {
+            DBG_PRINTF("Erase timed out\r\n");
+            status = SD_BLOCK_DEVICE_ERROR_ERASE;
+        }
+    }
+    sd_release(pSD);
+    return status;
+}
+
+#if SD_BAUD_PROBE
+#define SD_BAUD_PROBE_SECTORS 4 /*!< Sectors read at each rate */
+#define SD_BAUD_PROBE_READS 4   /*!< Reads of each sector per rate */
+
+// The sectors probed: the first one, which holds the partition table and is
+// rarely blank, and others spread evenly over the card
+static uint64_t sd_baud_probe_sector(sd_card_t *pSD, int i) {
+    return pSD->sectors / SD_BAUD_PROBE_SECTORS * i;
+}
+
+// Reads each probe sector repeatedly at the current rate and checks its
+// CRC (verified against the card's on every transfer) against the reference
+static bool sd_baud_probe(sd_card_t *pSD, const uint16_t *reference,
+                          uint8_t *scratch) {
+    for (int i = 0; i < SD_BAUD_PROBE_SECTORS; ++i) {
+        for (int j = 0; j < SD_BAUD_PROBE_READS; ++j) {
+            if (in_sd_read_blocks(pSD, scratch, sd_baud_probe_sector(pSD, i), 1))
+                return false;
+            if (crc16((void *)scratch, _block_size) != reference[i])
+                return false;
+        }
+    }
+    return true;
+}
+
+/* Picks the fastest SCK rate, up to the SPI's configured baud_rate, at which
+ * single-block reads (CMD17) of a few known sectors keep matching what they
+ * returned at the initialization rate. The probe only reads: the card's
+ * contents are never touched, so a failed probe or a power loss during
+ * sd_init() cannot cost any data.
+ */
+static void sd_negotiate_baud(sd_card_t *pSD) {
+    static uint8_t scratch[BLOCK_SIZE_HC];
+    uint16_t reference[SD_BAUD_PROBE_SECTORS];
+
+    pSD->baud_step = 0;
+    pSD->baud_rate = sd_baud_steps[0];
+    for (int i = 0; i < SD_BAUD_PROBE_SECTORS; ++i) {
+        if (in_sd_read_blocks(pSD, scratch, sd_baud_probe_sector(pSD, i), 1)) {
+            DBG_PRINTF("%s: reference read failed\r\n", __FUNCTION__);
+            sd_spi_go_high_frequency(pSD);
+            return;
+        }
+        reference[i] = crc16((void *)scratch, _block_size);
+    }
+    for (uint8_t step = 1; step < SD_BAUD_STEPS; ++step) {
+        if (sd_baud_steps[step] > pSD->spi->baud_rate) break;
+        pSD->baud_rate = sd_baud_steps[step];
+        sd_spi_go_high_frequency(pSD);
+        if (!sd_baud_probe(pSD, reference, scratch)) break;
+        pSD->baud_step = step;
+    }
+    pSD->baud_rate = sd_baud_steps[pSD->baud_step];
+    sd_spi_go_high_frequency(pSD);
+    DBG_PRINTF("%s: SCK %u Hz\r\n", __FUNCTION__, pSD->baud_rate);
+}
+#endif
+
+#if SD_SPI_BENCHMARK
+#define SD_BENCH_BYTES 1000 /*!< Single bytes timed per path */
+#define SD_BENCH_BLOCKS 100 /*!< Blocks timed per path */
+
+// Average time per iteration, in ns, since start
+static uint32_t sd_bench_ns(absolute_time_t start, uint32_t iterations) {
+    return (uint32_t)(absolute_time_diff_us(start, get_absolute_time()) * 1000 /
+                      iterations);
+}
+
+void sd_spi_benchmark(sd_card_t *pSD, sd_spi_benchmark_t *result) {
+    static uint8_t block[BLOCK_SIZE_HC + 2];  // Block and CRC
+    spi_t *spi = pSD->spi;
+    memset(result, 0, sizeof(*result));
+    sd_acquire(pSD);
+
+    // Fill bytes with no command pending: the card just keeps DO high
+    absolute_time_t start = get_absolute_time();
+    for (int i = 0; i < SD_BENCH_BYTES; ++i) spi_xchg(spi, SPI_FILL_CHAR);
+    result->xchg_ns = sd_bench_ns(start, SD_BENCH_BYTES);
+
+    start = get_absolute_time();
+    for (int i = 0; i < SD_BENCH_BYTES; ++i) {
+        spi_transfer_start(spi, NULL, block, 1);
+        spi_transfer_wait_complete(spi, 1000);
+    }
+    result->dma_byte_ns = sd_bench_ns(start, SD_BENCH_BYTES);
+
+    start = get_absolute_time();
+    for (int i = 0; i < SD_BENCH_BLOCKS; ++i) {
+        spi_transfer_start(spi, NULL, block, sizeof block);
+        spi_transfer_wait_complete(spi, 1000);
+    }
+    result->block_dma_ns = sd_bench_ns(start, SD_BENCH_BLOCKS);
+
+    start = get_absolute_time();
+    for (int i = 0; i < SD_BENCH_BLOCKS; ++i) {
+        if (in_sd_read_blocks(pSD, block, 0, 1)) ++result->read_errors;
+    }
+    result->cmd17_ns = sd_bench_ns(start, SD_BENCH_BLOCKS);
+
     sd_release(pSD);
+}
+#endif
+
+#if SD_ASYNC_WRITE_ENABLED
+/* Asynchronous write engine
+ * -------------------------
+ * sd_write_block() sends a block and then spins in sd_wait_ready() for as
+ * long as the card keeps DO low programming its flash, which can be hundreds
+ * of milliseconds. The engine below runs the same sequence as a state
+ * machine stepped from a repeating timer (alarm IRQ), so the caller only
+ * pays for filling a buffer.
+ *
+ * A step must never block: bytes are exchanged with polled single-byte SPI
+ * transfers, and the payload DMA is only started, its completion being
+ * checked on a later step. Synchronous accesses drain the queue in
+ * sd_lock(), so both paths never interleave on the bus.
+ */
+
+#define SD_ASYNC_POLL_US 100   /*!< Period of the timer stepping the engine */
+#define SD_ASYNC_POLL_BYTES 8  /*!< Busy bytes polled per step */
+
+typedef enum {
+    SD_ASYNC_IDLE = 0,
+    SD_ASYNC_COMMAND,  // Send CMD24/CMD25 for the request at the head of the queue
+    SD_ASYNC_DATA,     // Send the start token and start the payload DMA
+    SD_ASYNC_DMA,      // Wait for the DMA, send the CRC and get the data response
+    SD_ASYNC_BUSY,     // Poll until the card releases DO
+    SD_ASYNC_STATUS    // CMD13, then complete the request
+} sd_async_state_t;
+
+typedef enum {
+    SD_ASYNC_BUF_FREE = 0,
+    SD_ASYNC_BUF_FILLING,  // Handed to the caller
+    SD_ASYNC_BUF_QUEUED    // Submitted, queued or in flight
+} sd_async_buf_state_t;
+
+static uint8_t sd_async_xchg(sd_card_t *pSD, uint8_t value) {
+    return spi_xchg(pSD->spi, value);
+}
+
+// Steps run in the timer IRQ, where a DMA transfer waiting for the DMA IRQ
+// would never finish: commands are always polled.
+static uint8_t sd_async_cmd(sd_card_t *pSD, cmdSupported cmd, uint32_t arg,
+                            uint32_t *trailer) {
+    return sd_cmd_spi_xfer(pSD, cmd, arg, trailer, true);
+}
+
+static void sd_async_complete(sd_card_t *pSD, int status) {
+    sd_async_t *a = &pSD->async;
+
+    sd_spi_deselect(pSD);
+
+    critical_section_enter_blocking(&a->cs);
+    uint8_t idx = a->queue[a->head];
+    a->head = (a->head + 1) % SD_ASYNC_BUFFERS;
+    --a->count;
+    a->buf_state[idx] = SD_ASYNC_BUF_FREE;
+    a->stats.queue_depth = a->count;
+    ++a->stats.completed;
+    if (SD_BLOCK_DEVICE_ERROR_NONE != status) {
+        ++a->stats.errors;
+        if (SD_BLOCK_DEVICE_ERROR_NONE == a->error) a->error = status;
+    }
+    a->state = a->count ? SD_ASYNC_COMMAND : SD_ASYNC_IDLE;
+    critical_section_exit(&a->cs);
+
+    if (SD_BLOCK_DEVICE_ERROR_NONE != status)
+        DBG_PRINTF("%s: sector %llu failed: %d\r\n", __FUNCTION__,
+                   a->sector[idx], status);
+    if (a->callback) a->callback(pSD, status, a->callback_ctx);
+}
+
+static void sd_async_step(sd_card_t *pSD) {
+    sd_async_t *a = &pSD->async;
+    uint8_t idx = a->queue[a->head];
+    bool multi = a->blocks[idx] > 1;
+
+    switch (a->state) {
+        case SD_ASYNC_IDLE:
+            return;
+
+        case SD_ASYNC_COMMAND: {
+            uint64_t addr;
+            // SDSC Card (CCS=0) uses byte unit address
+            // SDHC and SDXC Cards (CCS=1) use block unit address (512 Bytes unit)
+            if (SDCARD_V2HC == pSD->card_type) {
+                addr = a->sector[idx];
+            } else {
+                addr = a->sector[idx] * _block_size;
+            }
+            a->block = 0;
+            a->status = SD_BLOCK_DEVICE_ERROR_NONE;
+            a->stop_sent = false;
+
+            // The previous request ended with the card ready, so there is no
+            // need for sd_wait_ready() before the command.
+            sd_spi_select(pSD);
+            uint8_t response = sd_async_cmd(
+                pSD, multi ? CMD25_WRITE_MULTIPLE_BLOCK : CMD24_WRITE_BLOCK, addr,
+                NULL);
+            if (R1_NO_RESPONSE == response) {
+                sd_async_complete(pSD, SD_BLOCK_DEVICE_ERROR_NO_DEVICE);
+                return;
+            }
+            if (response) {
+                sd_async_complete(pSD, SD_BLOCK_DEVICE_ERROR_WRITE);
+                return;
+            }
+            a->state = SD_ASYNC_DATA;
+        }
+        // fallthrough
+        case SD_ASYNC_DATA:
+            // indicate start of block
+            sd_async_xchg(pSD, multi ? SPI_START_BLK_MUL_WRITE : SPI_START_BLOCK);
+#if SD_CRC_ENABLED
+            spi_transfer_start_crc16(pSD->spi, a->data[idx] + a->block * _block_size,
+                                     NULL, _block_size);
+#else
+            spi_transfer_start(pSD->spi, a->data[idx] + a->block * _block_size,
+                               NULL, _block_size);
+#endif
+            a->state = SD_ASYNC_DMA;
+            return;  // Completion is checked on a later step
+
+        case SD_ASYNC_DMA: {
+            if (spi_transfer_is_busy(pSD->spi)) return;
+
+            uint16_t crc = (~0);
+#if SD_CRC_ENABLED
+            // Computed by the DMA sniffer
+            uint16_t crc_result = spi_transfer_get_crc16(pSD->spi);
+            if (crc_on) {
+                crc = crc_result;
+            }
+#endif
+            // write the checksum CRC16 and clock in the response token
+            uint8_t trailer_tx[3] = {crc >> 8, crc, SPI_FILL_CHAR};
+            uint8_t trailer_rx[3];
+            spi_transfer_polled(pSD->spi, trailer_tx, trailer_rx, sizeof trailer_tx);
+            uint8_t response = trailer_rx[2] & SPI_DATA_RESPONSE_MASK;
+            if (response != SPI_DATA_ACCEPTED) {
+                DBG_PRINTF("Async Block Write failed: 0x%x\r\n", response);
+                a->status = (SPI_DATA_CRC_ERROR == response)
+                                ? SD_BLOCK_DEVICE_ERROR_CRC
+                                : SD_BLOCK_DEVICE_ERROR_WRITE;
+                a->block = a->blocks[idx] - 1;  // Stop after this block
+            }
+            a->busy_start = get_absolute_time();
+            a->deadline = make_timeout_time_ms(SD_COMMAND_TIMEOUT);
+            a->state = SD_ASYNC_BUSY;
+            return;
+        }
+
+        case SD_ASYNC_BUSY: {
+            bool ready = false;
+            for (int i = 0; i < SD_ASYNC_POLL_BYTES && !ready; i++) {
+                ready = (0x00 != sd_async_xchg(pSD, SPI_FILL_CHAR));
+            }
+            if (!ready) {
+                if (time_reached(a->deadline)) {
+                    DBG_PRINTF("%s: Card not ready yet\r\n", __FUNCTION__);
+                    sd_async_complete(pSD, SD_BLOCK_DEVICE_ERROR_NO_RESPONSE);
+                }
+                return;
+            }
+            uint32_t busy_us = (uint32_t)absolute_time_diff_us(
+                a->busy_start, get_absolute_time());
+            if (busy_us > a->stats.max_busy_us) a->stats.max_busy_us = busy_us;
+
+            if (++a->block < a->blocks[idx]) {
+                a->state = SD_ASYNC_DATA;
+                return;
+            }
+            if (multi && !a->stop_sent) {
+                /* In a Multiple Block write operation, the stop transmission
+                 * is done by sending 'Stop Tran' token; the card goes busy
+                 * again after one stuff byte.
+                 */
+                sd_async_xchg(pSD, SPI_STOP_TRAN);
+                sd_async_xchg(pSD, SPI_FILL_CHAR);
+                a->stop_sent = true;
+                a->busy_start = get_absolute_time();
+                a->deadline = make_timeout_time_ms(SD_COMMAND_TIMEOUT);
+                return;
+            }
+            a->state = SD_ASYNC_STATUS;
+        }
+        // fallthrough
+        case SD_ASYNC_STATUS: {
+            // Some SD cards want to be deselected between every bus transaction:
+            sd_spi_deselect_pulse(pSD);
+            uint32_t r2 = 0;
+            uint8_t response = sd_async_cmd(pSD, CMD13_SEND_STATUS, 0, &r2);
+            if (SD_BLOCK_DEVICE_ERROR_NONE == a->status && (response || r2)) {
+                DBG_PRINTF("%s: R2: 0x%02x%02x\r\n", __FUNCTION__, response, r2);
+                a->status = SD_BLOCK_DEVICE_ERROR_WRITE;
+            }
+            // The card rejected the data CRC: slow down and resend the request
+            if (SD_BLOCK_DEVICE_ERROR_CRC == a->status && sd_baud_step_down(pSD)) {
+                sd_spi_deselect(pSD);
+                a->state = SD_ASYNC_COMMAND;
+                return;
+            }
+            sd_async_complete(pSD, a->status);
+            return;
+        }
+    }
+}
+
+// Runs one step unless another context is already stepping the engine
+static void sd_async_try_step(sd_card_t *pSD) {
+    sd_async_t *a = &pSD->async;
+    critical_section_enter_blocking(&a->cs);
+    bool mine = !a->stepping;
+    a->stepping = true;
+    critical_section_exit(&a->cs);
+    if (!mine) return;
+    sd_async_step(pSD);
+    a->stepping = false;
+}
+
+static bool sd_async_timer_callback(repeating_timer_t *rt) {
+    sd_card_t *pSD = rt->user_data;
+    sd_async_t *a = &pSD->async;
+    sd_async_try_step(pSD);
+
+    // Stop when there is nothing left; sd_write_async_submit() restarts us
+    critical_section_enter_blocking(&a->cs);
+    bool keep_going = SD_ASYNC_IDLE != a->state;
+    if (!keep_going) a->timer_running = false;
+    critical_section_exit(&a->cs);
+    return keep_going;
+}
+
+// Waits for the queue to empty. Caller holds the card mutex.
+static void sd_write_async_drain(sd_card_t *pSD) {
+    while (SD_ASYNC_IDLE != pSD->async.state) {
+        // Step from here too: the timer may not be able to preempt us
+        sd_async_try_step(pSD);
+        tight_loop_contents();
+    }
+}
+
+uint8_t *sd_write_async_get_buffer(sd_card_t *pSD) {
+    sd_async_t *a = &pSD->async;
+    absolute_time_t start = get_absolute_time();
+    bool stalled = false;
+    for (;;) {
+        critical_section_enter_blocking(&a->cs);
+        for (size_t i = 0; i < SD_ASYNC_BUFFERS; ++i) {
+            if (SD_ASYNC_BUF_FREE == a->buf_state[i]) {
+                a->buf_state[i] = SD_ASYNC_BUF_FILLING;
+                critical_section_exit(&a->cs);
+                if (stalled) {
+                    uint32_t stall_us = (uint32_t)absolute_time_diff_us(
+                        start, get_absolute_time());
+                    if (stall_us > a->stats.max_stall_us)
+                        a->stats.max_stall_us = stall_us;
+                }
+                return a->data[i];
+            }
+        }
+        critical_section_exit(&a->cs);
+        // Every buffer is in flight: help the engine along
+        stalled = true;
+        sd_async_try_step(pSD);
+        tight_loop_contents();
+    }
+}
+
+/** Queue blocks for writing in the background
+ *
+ *  @param buffer          Buffer obtained from sd_write_async_get_buffer()
+ *  @param ulSectorNumber  Logical Address of block to begin writing to (LBA)
+ *  @param blockCnt        Size to write in blocks (1 to SD_ASYNC_BUFFER_BLOCKS)
+ *  @return  SD_BLOCK_DEVICE_ERROR_PARAMETER if the request is rejected (the
+ *           buffer is released), otherwise the first error reported by a
+ *           request completed since the last call, if any.
+ */
+int sd_write_async_submit(sd_card_t *pSD, uint8_t *buffer,
+                          uint64_t ulSectorNumber, uint32_t blockCnt) {
+    sd_async_t *a = &pSD->async;
+    size_t idx = (buffer - a->data[0]) / sizeof a->data[0];
+    myASSERT(idx < SD_ASYNC_BUFFERS && buffer == a->data[idx]);
+    myASSERT(SD_ASYNC_BUF_FILLING == a->buf_state[idx]);
+
+    if (!blockCnt || blockCnt > SD_ASYNC_BUFFER_BLOCKS ||
+        ulSectorNumber + blockCnt > pSD->sectors ||
+        (pSD->m_Status & (STA_NOINIT | STA_NODISK))) {
+        a->buf_state[idx] = SD_ASYNC_BUF_FREE;
+        return SD_BLOCK_DEVICE_ERROR_PARAMETER;
+    }
+    a->sector[idx] = ulSectorNumber;
+    a->blocks[idx] = blockCnt;
+
+    // Not while a synchronous operation owns the card
+    mutex_enter_blocking(&pSD->mutex);
+
+    critical_section_enter_blocking(&a->cs);
+    a->queue[(a->head + a->count) % SD_ASYNC_BUFFERS] = idx;
+    ++a->count;
+    a->buf_state[idx] = SD_ASYNC_BUF_QUEUED;
+    ++a->stats.submitted;
+    a->stats.queue_depth = a->count;
+    if (a->count > a->stats.max_queue_depth) a->stats.max_queue_depth = a->count;
+    if (SD_ASYNC_IDLE == a->state) a->state = SD_ASYNC_COMMAND;
+    bool start_timer = !a->timer_running;
+    a->timer_running = true;
+    int status = a->error;
+    a->error = SD_BLOCK_DEVICE_ERROR_NONE;
+    critical_section_exit(&a->cs);
+
+    if (start_timer) {
+        // Negative delay: period counted from the start of each callback
+        bool ok = add_repeating_timer_us(-SD_ASYNC_POLL_US, sd_async_timer_callback,
+                                         pSD, &a->timer);
+        myASSERT(ok);
+    }
+    mutex_exit(&pSD->mutex);
+    return status;
+}
+
+// Waits until every queued block is on the card and returns the first
+// error reported since the last flush (or submit).
+int sd_write_async_flush(sd_card_t *pSD) {
+    sd_lock(pSD);  // Drains the queue
+    sd_async_t *a = &pSD->async;
+    critical_section_enter_blocking(&a->cs);
+    int status = a->error;
+    a->error = SD_BLOCK_DEVICE_ERROR_NONE;
+    critical_section_exit(&a->cs);
+    sd_unlock(pSD);
     return status;
 }
 
+bool sd_write_async_busy(sd_card_t *pSD) {
+    return SD_ASYNC_IDLE != pSD->async.state;
+}
+
+void sd_write_async_set_callback(sd_card_t *pSD, sd_async_callback_t callback,
+                                 void *ctx) {
+    critical_section_enter_blocking(&pSD->async.cs);
+    pSD->async.callback = callback;
+    pSD->async.callback_ctx = ctx;
+    critical_section_exit(&pSD->async.cs);
+}
+
+void sd_write_async_get_stats(sd_card_t *pSD, sd_async_stats_t *stats) {
+    critical_section_enter_blocking(&pSD->async.cs);
+    *stats = pSD->async.stats;
+    critical_section_exit(&pSD->async.cs);
+}
+#endif
+
 static int sd_init_medium(sd_card_t *pSD) {
     int32_t status = SD_BLOCK_DEVICE_ERROR_NONE;
     uint32_t response, arg;
@@ -1138,6 +1919,9 @@ static void sd_ctor(sd_card_t *pSD) {
     pSD->write_blocks = sd_write_blocks;
     pSD->read_blocks = sd_read_blocks;
     pSD->sd_test_com = sd_test_com;
+#if SD_ASYNC_WRITE_ENABLED
+    critical_section_init(&pSD->async.cs);
+#endif
 }
 bool sd_init_driver() {
     static bool initialized;
@@ -1224,12 +2008,22 @@ static int sd_init(sd_card_t *pSD) {
         sd_unlock(pSD);
         return pSD->m_Status;
     }
-    // Set SCK for data transfer
-    sd_spi_go_high_frequency(pSD);
+    // AU_SIZE is only defined from SD 2.0 on
+    pSD->au_sectors = 0;
+    pSD->speed_class = 0;
+    if (SDCARD_V1 != pSD->card_type) sd_read_sd_status(pSD);
 
     // The card is now initialized
     pSD->m_Status &= ~STA_NOINIT;
 
+    // Set SCK for data transfer
+#if SD_BAUD_PROBE
+    sd_negotiate_baud(pSD);
+#else
+    pSD->baud_rate = 0;  // The SPI's baud_rate
+    sd_spi_go_high_frequency(pSD);
+#endif
+
     sd_spi_release(pSD);
     sd_unlock(pSD);
 
@@ -1254,7 +2048,7 @@ static bool sd_test_com(sd_card_t *pSD) {
             uint32_t response;
             for (int i = 0; i < SD_COMMAND_RETRIES; i++) {
                 // Send command over SPI interface
-                response = sd_cmd_spi(pSD, CMD13_SEND_STATUS, 0);
+                response = sd_cmd_spi(pSD, CMD13_SEND_STATUS, 0, NULL);
                 if (R1_NO_RESPONSE != response) {
                     // Got a response!
                     success = true;
@@ -1284,7 +2078,7 @@ static bool sd_test_com(sd_card_t *pSD) {
             uint32_t response;
             for (int i = 0; i < SD_COMMAND_RETRIES; i++) {
                 // Send command over SPI interface
-                response = sd_cmd_spi(pSD, CMD0_GO_IDLE_STATE, 0);
+                response = sd_cmd_spi(pSD, CMD0_GO_IDLE_STATE, 0, NULL);
                 if (R1_NO_RESPONSE != response) {
                     // Got a response!
                     success = true;
@@ -20,7 +20,9 @@ specific language governing permissions and limitations under the License.
 #include <stdint.h>
 //
 #include "hardware/gpio.h"
+#include "pico/critical_section.h"
 #include "pico/mutex.h"
+#include "pico/time.h"
 //
 #include "ff.h"
 //
@@ -32,6 +34,64 @@ extern "C" {
 
 typedef struct sd_card_t sd_card_t;
 
+// Asynchronous (write-behind) block writes. See sd_write_async_submit().
+#ifndef SD_ASYNC_WRITE_ENABLED
+#define SD_ASYNC_WRITE_ENABLED 1
+#endif
+#define SD_ASYNC_BUFFERS 2        // Double buffering: fill one while the other is written
+#define SD_ASYNC_BUFFER_BLOCKS 4  // Capacity of each buffer, in 512-byte blocks
+
+typedef void (*sd_async_callback_t)(sd_card_t *sd_card_p, int status, void *ctx);
+
+// On-target SPI timing, see sd_spi_benchmark(). Off by default.
+#ifndef SD_SPI_BENCHMARK
+#define SD_SPI_BENCHMARK 0
+#endif
+
+typedef struct {
+    uint32_t xchg_ns;        // One byte polled through the FIFO by spi_xchg()
+    uint32_t dma_byte_ns;    // One byte through a DMA transfer and its IRQ
+    uint32_t block_dma_ns;   // 514 bytes (block and CRC) through DMA, no command
+    uint32_t cmd17_ns;       // A whole single-block read: command, token wait, block, CRC
+    uint32_t read_errors;    // Failed reads among the timed ones
+} sd_spi_benchmark_t;
+
+typedef struct {
+    uint32_t submitted;        // Requests accepted by sd_write_async_submit()
+    uint32_t completed;        // Requests finished, successfully or not
+    uint32_t errors;           // Requests that finished with an error
+    uint32_t queue_depth;      // Requests queued or in flight right now
+    uint32_t max_queue_depth;  // High-water mark of queue_depth
+    uint32_t max_stall_us;     // Longest wait in sd_write_async_get_buffer()
+    uint32_t max_busy_us;      // Longest time the card held DO low programming a block
+} sd_async_stats_t;
+
+// State of the asynchronous write engine (one per card)
+typedef struct {
+    uint8_t data[SD_ASYNC_BUFFERS][SD_ASYNC_BUFFER_BLOCKS * 512];
+    uint64_t sector[SD_ASYNC_BUFFERS];
+    uint32_t blocks[SD_ASYNC_BUFFERS];
+    volatile uint8_t buf_state[SD_ASYNC_BUFFERS];
+    volatile uint8_t queue[SD_ASYNC_BUFFERS];  // FIFO of buffer indexes
+    volatile uint8_t head;
+    volatile uint8_t count;
+    volatile uint8_t state;
+    volatile bool stepping;
+    volatile bool timer_running;
+    volatile int error;  // Sticky: first error since the last flush
+    // Current request:
+    uint32_t block;
+    int status;
+    bool stop_sent;
+    absolute_time_t deadline;
+    absolute_time_t busy_start;
+    repeating_timer_t timer;
+    critical_section_t cs;
+    sd_async_callback_t callback;
+    void *callback_ctx;
+    sd_async_stats_t stats;
+} sd_async_t;
+
 // "Class" representing SD Cards
 struct sd_card_t {
     const char *pcName;
@@ -54,6 +114,12 @@ struct sd_card_t {
     mutex_t mutex;
     FATFS fatfs;
     bool mounted;
+    uint baud_rate;                                  // SCK rate negotiated by sd_init()
+    uint8_t baud_step;                               // Index of baud_rate in the probe steps
+    uint32_t baud_fallbacks;                         // Rate reductions after CRC errors
+    uint32_t au_sectors;                             // Allocation unit (SD Status), 0 if unknown
+    uint32_t erase_sectors;                          // Erase sector size (CSD)
+    uint8_t speed_class;                             // Speed class (SD Status): 0, 2, 4, 6 or 10
 
     int (*init)(sd_card_t *sd_card_p);
     int (*write_blocks)(sd_card_t *sd_card_p, const uint8_t *buffer,
@@ -64,6 +130,10 @@ struct sd_card_t {
     // Useful when use_card_detect is false - call periodically to check for presence of SD card
     // Returns true if and only if SD card was sensed on the bus
     bool (*sd_test_com)(sd_card_t *sd_card_p);
+
+#if SD_ASYNC_WRITE_ENABLED
+    sd_async_t async;
+#endif
 };
 
 #define SD_BLOCK_DEVICE_ERROR_NONE 0
@@ -89,10 +159,46 @@ struct sd_card_t {
 
 bool sd_card_detect(sd_card_t *pSD);
 uint64_t sd_sectors(sd_card_t *pSD);
+int sd_erase_blocks(sd_card_t *pSD, uint64_t ulSectorNumber, uint32_t blockCnt);
 
 bool sd_init_driver();
 bool sd_card_detect(sd_card_t *sd_card_p);
 
+#if SD_ASYNC_WRITE_ENABLED
+/* Asynchronous writes
+ *
+ * A buffer obtained with sd_write_async_get_buffer() is filled by the caller
+ * and handed back with sd_write_async_submit(). The command, the payload DMA
+ * and the wait while the card programs its flash then run in the background,
+ * stepped by a repeating timer. The buffer returns to the pool (and the
+ * optional callback runs, in IRQ context) once the card reports the
+ * block(s) written, so the caller can fill the other buffer meanwhile.
+ *
+ * Synchronous operations on the card wait for the queue to drain first.
+ * The card must not share its SPI with another card while writes are queued.
+ */
+uint8_t *sd_write_async_get_buffer(sd_card_t *sd_card_p);
+int sd_write_async_submit(sd_card_t *sd_card_p, uint8_t *buffer,
+                          uint64_t ulSectorNumber, uint32_t blockCnt);
+int sd_write_async_flush(sd_card_t *sd_card_p);
+bool sd_write_async_busy(sd_card_t *sd_card_p);
+void sd_write_async_set_callback(sd_card_t *sd_card_p, sd_async_callback_t callback,
+                                 void *ctx);
+void sd_write_async_get_stats(sd_card_t *sd_card_p, sd_async_stats_t *stats);
+#endif
+
+#if SD_SPI_BENCHMARK
+/* Times the SPI paths on the card at its current rate. A byte exchanged by
+ * spi_xchg() against one through DMA gives the per-byte cost of each path;
+ * cmd17_ns - block_dma_ns is what a block read spends outside the payload
+ * (command, response, waiting for the token). Building with
+ * SPI_POLLED_MAX=0 sends the commands and every single byte of the
+ * synchronous driver (tokens, busy polling) through DMA again, as before,
+ * for comparison; the asynchronous engine stays polled.
+ */
+void sd_spi_benchmark(sd_card_t *sd_card_p, sd_spi_benchmark_t *result);
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -31,7 +31,9 @@ specific language governing permissions and limitations under the License.
 #pragma GCC diagnostic ignored "-Wunused-variable"
 
 void sd_spi_go_high_frequency(sd_card_t *pSD) {
-    uint actual = spi_set_baudrate(pSD->spi->hw_inst, pSD->spi->baud_rate);
+    // The rate negotiated for this card, if any, else the SPI's ceiling
+    uint baud_rate = pSD->baud_rate ? pSD->baud_rate : pSD->spi->baud_rate;
+    uint actual = spi_set_baudrate(pSD->spi->hw_inst, baud_rate);
     TRACE_PRINTF("%s: Actual frequency: %lu\n", __FUNCTION__, (long)actual);
 }
 void sd_spi_go_low_frequency(sd_card_t *pSD) {
@@ -49,7 +51,7 @@ static void sd_spi_unlock(sd_card_t *pSD) {
 }
 
 // Would do nothing if pSD->ss_gpio were set to GPIO_FUNC_SPI.
-static void sd_spi_select(sd_card_t *pSD) {
+void sd_spi_select(sd_card_t *pSD) {
     gpio_put(pSD->ss_gpio, 0);
     // A fill byte seems to be necessary, sometimes:
     uint8_t fill = SPI_FILL_CHAR;
@@ -57,7 +59,7 @@ static void sd_spi_select(sd_card_t *pSD) {
     LED_ON();
 }
 
-static void sd_spi_deselect(sd_card_t *pSD) {
+void sd_spi_deselect(sd_card_t *pSD) {
     gpio_put(pSD->ss_gpio, 1);
     LED_OFF();
     /*
@@ -91,17 +93,23 @@ bool sd_spi_transfer(sd_card_t *pSD, const uint8_t *tx, uint8_t *rx,
     return spi_transfer(pSD->spi, tx, rx, length);
 }
 
+bool sd_spi_transfer_crc16(sd_card_t *pSD, const uint8_t *tx, uint8_t *rx,
+                           size_t length, uint16_t *crc) {
+    return spi_transfer_crc16(pSD->spi, tx, rx, length, crc);
+}
+
 uint8_t sd_spi_write(sd_card_t *pSD, const uint8_t value) {
     // TRACE_PRINTF("%s\n", __FUNCTION__);
-    uint8_t received = SPI_FILL_CHAR;
-#if 0
-    int num = spi_write_read_blocking(pSD->spi->hw_inst, &value, &received, 1);
-    myASSERT(1 == num);
+    // Polled: a DMA round trip per byte would dominate the command,
+    // token and busy loops. SPI_POLLED_MAX 0 brings that round trip back,
+    // for comparison.
+#if SPI_POLLED_MAX
+    return spi_xchg(pSD->spi, value);
 #else
-    bool success = spi_transfer(pSD->spi, &value, &received, 1);
-    myASSERT(success);
-#endif
+    uint8_t received;
+    spi_transfer(pSD->spi, &value, &received, 1);
     return received;
+#endif
 }
 
 void sd_spi_send_initializing_sequence(sd_card_t * pSD) {
@@ -21,7 +21,13 @@ specific language governing permissions and limitations under the License.
 /* Transfer tx to SPI while receiving SPI to rx. 
 tx or rx can be NULL if not important. */
 bool sd_spi_transfer(sd_card_t *pSD, const uint8_t *tx, uint8_t *rx, size_t length);
+/* Same, also returning the CRC16 of the data sent (tx) or received (!tx),
+computed by the DMA sniffer. */
+bool sd_spi_transfer_crc16(sd_card_t *pSD, const uint8_t *tx, uint8_t *rx, size_t length,
+                           uint16_t *crc);
 uint8_t sd_spi_write(sd_card_t *pSD, const uint8_t value);
+void sd_spi_select(sd_card_t *pSD);
+void sd_spi_deselect(sd_card_t *pSD);
 void sd_spi_deselect_pulse(sd_card_t *pSD);
 void sd_spi_acquire(sd_card_t *pSD);
 void sd_spi_release(sd_card_t *pSD);
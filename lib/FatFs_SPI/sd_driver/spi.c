@@ -54,15 +54,15 @@ void set_spi_dma_irq_channel(bool useChannel1, bool shared) {
     irqShared = shared;
 }
 
-// SPI Transfer: Read & Write (simultaneously) on SPI bus
+// Start an SPI transfer without waiting for it to finish
+//   The buffers must stay valid until spi_transfer_is_busy() returns false
+//   or spi_transfer_wait_complete() returns.
 //   If the data that will be received is not important, pass NULL as rx.
 //   If the data that will be transmitted is not important,
 //     pass NULL as tx and then the SPI_FILL_CHAR is sent out as each data
 //     element.
-bool spi_transfer(spi_t *spi_p, const uint8_t *tx, uint8_t *rx, size_t length) {
-    // assert(512 == length || 1 == length);
+static void spi_transfer_configure(spi_t *spi_p, const uint8_t *tx, uint8_t *rx, size_t length) {
     assert(tx || rx);
-    // assert(!(tx && rx));
 
     // tx write increment is already false
     if (tx) {
@@ -106,15 +106,102 @@ bool spi_transfer(spi_t *spi_p, const uint8_t *tx, uint8_t *rx, size_t length) {
             assert(false);
     }
     sem_reset(&spi_p->sem, 0);
+}
 
+static void spi_transfer_go(spi_t *spi_p) {
     // start them exactly simultaneously to avoid races (in extreme cases
     // the FIFO could overflow)
     dma_start_channel_mask((1u << spi_p->tx_dma) | (1u << spi_p->rx_dma));
+}
+
+void spi_transfer_start(spi_t *spi_p, const uint8_t *tx, uint8_t *rx, size_t length) {
+    spi_transfer_configure(spi_p, tx, rx, length);
+    spi_transfer_go(spi_p);
+}
+
+/* The RP2040 DMA sniffer can compute the CRC-16-CCITT (polynomial 0x1021,
+   no reflection) of the data passing through one channel. Seeded with 0,
+   that is exactly the CRC16 of SD data blocks, so the CRC comes for free
+   while the DMA moves the block instead of costing a table lookup per byte.
+   The sniffer watches the outgoing channel when there is data to send and
+   the incoming one otherwise. There is only one sniffer: only one transfer
+   at a time may use it. */
+#define DMA_SNIFF_CTRL_CALC_CRC16_CCITT 0x2
+
+void spi_transfer_start_crc16(spi_t *spi_p, const uint8_t *tx, uint8_t *rx, size_t length) {
+    spi_transfer_configure(spi_p, tx, rx, length);
+    dma_sniffer_enable(tx ? spi_p->tx_dma : spi_p->rx_dma,
+                       DMA_SNIFF_CTRL_CALC_CRC16_CCITT, true);
+    dma_hw->sniff_data = 0;  // Seed
+    spi_transfer_go(spi_p);
+}
+
+// CRC16 of the last transfer started by spi_transfer_start_crc16(),
+// valid once it has completed
+uint16_t spi_transfer_get_crc16(spi_t *spi_p) {
+    (void)spi_p;
+    uint16_t crc = dma_hw->sniff_data;
+    dma_sniffer_disable();
+    return crc;
+}
+
+/* Receive-only transfer split across two chained channels: `length` bytes
+   into rx, then, with no gap on the bus, `tail_length` more into tail.
+   This lets a block reader get a data block, its CRC and the first bytes
+   after it in one go, without copying the block through a bigger buffer.
+   Only the rx part is sniffed by the _crc16 variant, and `seed` lets it
+   resume a CRC started over bytes received earlier.
+   Completion is only seen by spi_transfer_is_busy(): the IRQ fires when
+   the first channel finishes. */
+static void spi_transfer_configure_rx_tail(spi_t *spi_p, uint8_t *rx, size_t length,
+                                           uint8_t *tail, size_t tail_length) {
+    static const uint8_t dummy = SPI_FILL_CHAR;
+    assert(rx && length && tail && tail_length);
+
+    channel_config_set_read_increment(&spi_p->tx_dma_cfg, false);
+    channel_config_set_write_increment(&spi_p->rx_dma_cfg, true);
+    dma_channel_config rx_cfg = spi_p->rx_dma_cfg;
+    channel_config_set_chain_to(&rx_cfg, spi_p->rx_tail_dma);
+
+    dma_channel_configure(spi_p->tx_dma, &spi_p->tx_dma_cfg,
+                          &spi_get_hw(spi_p->hw_inst)->dr, &dummy,
+                          length + tail_length, false);
+    dma_channel_configure(spi_p->rx_dma, &rx_cfg,
+                          rx, &spi_get_hw(spi_p->hw_inst)->dr,
+                          length, false);
+    dma_channel_configure(spi_p->rx_tail_dma, &spi_p->rx_tail_dma_cfg,
+                          tail, &spi_get_hw(spi_p->hw_inst)->dr,
+                          tail_length, false);
+    sem_reset(&spi_p->sem, 0);
+}
 
+void spi_transfer_start_rx_tail(spi_t *spi_p, uint8_t *rx, size_t length,
+                                uint8_t *tail, size_t tail_length) {
+    spi_transfer_configure_rx_tail(spi_p, rx, length, tail, tail_length);
+    spi_transfer_go(spi_p);
+}
+
+void spi_transfer_start_rx_tail_crc16(spi_t *spi_p, uint8_t *rx, size_t length,
+                                      uint8_t *tail, size_t tail_length, uint16_t seed) {
+    spi_transfer_configure_rx_tail(spi_p, rx, length, tail, tail_length);
+    dma_sniffer_enable(spi_p->rx_dma, DMA_SNIFF_CTRL_CALC_CRC16_CCITT, true);
+    dma_hw->sniff_data = seed;
+    spi_transfer_go(spi_p);
+}
+
+// Non-blocking check for a transfer started by spi_transfer_start().
+//   Looks at the channels directly instead of the semaphore, so it also
+//   works where the DMA IRQ cannot preempt the caller.
+bool spi_transfer_is_busy(spi_t *spi_p) {
+    return dma_channel_is_busy(spi_p->tx_dma) || dma_channel_is_busy(spi_p->rx_dma) ||
+           dma_channel_is_busy(spi_p->rx_tail_dma);
+}
+
+// Wait for a transfer started by spi_transfer_start() to finish
+bool spi_transfer_wait_complete(spi_t *spi_p, uint32_t timeout_ms) {
     /* Wait until master completes transfer or time out has occured. */
-    uint32_t timeOut = 1000; /* Timeout 1 sec */
     bool rc = sem_acquire_timeout_ms(
-        &spi_p->sem, timeOut);  // Wait for notification from ISR
+        &spi_p->sem, timeout_ms);  // Wait for notification from ISR
     if (!rc) {
         // If the timeout is reached the function will return false
         DBG_PRINTF("Notification wait timed out in %s\n", __FUNCTION__);
@@ -131,6 +218,55 @@ bool spi_transfer(spi_t *spi_p, const uint8_t *tx, uint8_t *rx, size_t length) {
     return true;
 }
 
+// Transfer through the FIFO, polled: never waits for the DMA IRQ
+void __not_in_flash_func(spi_transfer_polled)(spi_t *spi_p, const uint8_t *tx,
+                                              uint8_t *rx, size_t length) {
+    if (tx && rx) {
+        spi_write_read_blocking(spi_p->hw_inst, tx, rx, length);
+    } else if (tx) {
+        spi_write_blocking(spi_p->hw_inst, tx, length);
+    } else {
+        spi_read_blocking(spi_p->hw_inst, SPI_FILL_CHAR, rx, length);
+    }
+}
+
+// Exchange a single byte, polling the FIFO.
+//   Every other path leaves the RX FIFO empty, so the byte read back is the
+//   one clocked in while `value` went out.
+uint8_t __not_in_flash_func(spi_xchg)(spi_t *spi_p, uint8_t value) {
+    spi_hw_t *hw = spi_get_hw(spi_p->hw_inst);
+    while (!spi_is_writable(spi_p->hw_inst)) tight_loop_contents();
+    hw->dr = value;
+    while (!spi_is_readable(spi_p->hw_inst)) tight_loop_contents();
+    return (uint8_t)hw->dr;
+}
+
+// SPI Transfer: Read & Write (simultaneously) on SPI bus
+//   If the data that will be received is not important, pass NULL as rx.
+//   If the data that will be transmitted is not important,
+//     pass NULL as tx and then the SPI_FILL_CHAR is sent out as each data
+//     element.
+bool spi_transfer(spi_t *spi_p, const uint8_t *tx, uint8_t *rx, size_t length) {
+    // assert(512 == length || 1 == length);
+    // assert(!(tx && rx));
+    if (length <= SPI_POLLED_MAX) {
+        spi_transfer_polled(spi_p, tx, rx, length);
+        return true;
+    }
+    spi_transfer_start(spi_p, tx, rx, length);
+    return spi_transfer_wait_complete(spi_p, 1000); /* Timeout 1 sec */
+}
+
+// spi_transfer() that also returns the CRC16 of the data sent (if tx) or
+// received (if !tx), computed by the DMA sniffer
+bool spi_transfer_crc16(spi_t *spi_p, const uint8_t *tx, uint8_t *rx, size_t length,
+                        uint16_t *crc) {
+    spi_transfer_start_crc16(spi_p, tx, rx, length);
+    bool rc = spi_transfer_wait_complete(spi_p, 1000); /* Timeout 1 sec */
+    *crc = spi_transfer_get_crc16(spi_p);
+    return rc;
+}
+
 void spi_lock(spi_t *spi_p) {
     assert(mutex_is_initialized(&spi_p->mutex));
     mutex_enter_blocking(&spi_p->mutex);
@@ -186,6 +322,7 @@ bool my_spi_init(spi_t *spi_p) {
         // Grab some unused dma channels
         spi_p->tx_dma = dma_claim_unused_channel(true);
         spi_p->rx_dma = dma_claim_unused_channel(true);
+        spi_p->rx_tail_dma = dma_claim_unused_channel(true);
 
         spi_p->tx_dma_cfg = dma_channel_get_default_config(spi_p->tx_dma);
         spi_p->rx_dma_cfg = dma_channel_get_default_config(spi_p->rx_dma);
@@ -210,6 +347,11 @@ bool my_spi_init(spi_t *spi_p) {
                                                        : DREQ_SPI0_RX);
         channel_config_set_read_increment(&spi_p->rx_dma_cfg, false);
 
+        // The tail channel is the same, always writing to its buffer
+        spi_p->rx_tail_dma_cfg = spi_p->rx_dma_cfg;
+        channel_config_set_chain_to(&spi_p->rx_tail_dma_cfg, spi_p->rx_tail_dma);
+        channel_config_set_write_increment(&spi_p->rx_tail_dma_cfg, true);
+
         /* Theory: we only need an interrupt on rx complete,
         since if rx is complete, tx must also be complete. */
 
@@ -27,6 +27,17 @@ specific language governing permissions and limitations under the License.
 
 #define SPI_FILL_CHAR (0xFF)
 
+/* Setting up two DMA channels and waiting for the IRQ to release the
+   semaphore costs far more than clocking a few bytes, so spi_transfer()
+   polls the FIFO for transfers up to this length (commands, tokens, CRCs,
+   busy polling); DMA is kept for the data blocks. 0 restores the old
+   behaviour for timing comparisons: every spi_transfer() and every byte of
+   sd_spi_write() goes through DMA. Code running in an IRQ must not depend
+   on this, and uses spi_xchg() and spi_transfer_polled() instead. */
+#ifndef SPI_POLLED_MAX
+#define SPI_POLLED_MAX 32  // Room for a whole SD command and its response
+#endif
+
 // "Class" representing SPIs
 typedef struct {
     // SPI HW
@@ -47,8 +58,10 @@ typedef struct {
     // State variables:
     uint tx_dma;
     uint rx_dma;
+    uint rx_tail_dma; // Chained after rx_dma by spi_transfer_start_rx_tail()
     dma_channel_config tx_dma_cfg;
     dma_channel_config rx_dma_cfg;
+    dma_channel_config rx_tail_dma_cfg;
     irq_handler_t dma_isr; // Ignored: no longer used
     bool initialized;  
     semaphore_t sem;
@@ -60,6 +73,20 @@ extern "C" {
 #endif
   
 bool __not_in_flash_func(spi_transfer)(spi_t *pSPI, const uint8_t *tx, uint8_t *rx, size_t length);  
+uint8_t __not_in_flash_func(spi_xchg)(spi_t *pSPI, uint8_t value);
+void __not_in_flash_func(spi_transfer_polled)(spi_t *pSPI, const uint8_t *tx, uint8_t *rx,
+                                              size_t length);
+void spi_transfer_start(spi_t *pSPI, const uint8_t *tx, uint8_t *rx, size_t length);
+bool spi_transfer_is_busy(spi_t *pSPI);
+bool spi_transfer_wait_complete(spi_t *pSPI, uint32_t timeout_ms);
+void spi_transfer_start_crc16(spi_t *pSPI, const uint8_t *tx, uint8_t *rx, size_t length);
+uint16_t spi_transfer_get_crc16(spi_t *pSPI);
+bool spi_transfer_crc16(spi_t *pSPI, const uint8_t *tx, uint8_t *rx, size_t length,
+                        uint16_t *crc);
+void spi_transfer_start_rx_tail(spi_t *pSPI, uint8_t *rx, size_t length,
+                                uint8_t *tail, size_t tail_length);
+void spi_transfer_start_rx_tail_crc16(spi_t *pSPI, uint8_t *rx, size_t length,
+                                      uint8_t *tail, size_t tail_length, uint16_t seed);
 void spi_lock(spi_t *pSPI);
 void spi_unlock(spi_t *pSPI);
 bool my_spi_init(spi_t *pSPI);
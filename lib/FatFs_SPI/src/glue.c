@@ -20,11 +20,13 @@ specific language governing permissions and limitations under the License.
 /* storage control modules to the FatFs module with a defined API.       */
 /*-----------------------------------------------------------------------*/
 #include <stdio.h>
+#include <string.h>
 //
 #include "ff.h" /* Obtains integer types */
 //
 #include "diskio.h" /* Declarations of disk functions */
 //
+#include "disk_cache.h"
 #include "hw_config.h"
 #include "my_debug.h"
 #include "sd_card.h"
@@ -49,6 +51,8 @@ DSTATUS disk_status(BYTE pdrv /* Physical drive nmuber to identify the drive */
 /* Inidialize a Drive                                                    */
 /*-----------------------------------------------------------------------*/
 
+static void cache_forget(BYTE pdrv);
+
 DSTATUS disk_initialize(
     BYTE pdrv /* Physical drive nmuber to identify the drive */
 ) {
@@ -59,6 +63,9 @@ DSTATUS disk_initialize(
 
     sd_card_t *p_sd = sd_get_by_num(pdrv);
     if (!p_sd) return RES_PARERR;
+    // The card may have been swapped or power cycled since the sectors were
+    // cached
+    cache_forget(pdrv);
     // See http://elm-chan.org/fsw/ff/doc/dstat.html
     return p_sd->init(p_sd);  
 }
@@ -86,6 +93,237 @@ static int sdrc2dresult(int sd_rc) {
     }
 }
 
+static disk_cache_stats_t cache_stats;
+
+void disk_cache_get_stats(disk_cache_stats_t *stats) {
+    *stats = cache_stats;
+}
+
+/*-----------------------------------------------------------------------*/
+/* Metadata read cache                                                   */
+/*-----------------------------------------------------------------------*/
+/* FatFs keeps a single sector window, so walking a long FAT chain or     */
+/* going back to the directory entry on every sync re-reads the same few  */
+/* sectors over and over. Single-sector reads, which is how FatFs reads   */
+/* FAT and directory sectors, are kept here, least recently used          */
+/* replaced first. disk_write() refreshes the copies, so they never go    */
+/* stale. Like the write-back cache below, each drive has its own.       */
+/* Set DISK_RD_CACHE_SECTORS to 0 to disable.                             */
+
+#ifndef DISK_RD_CACHE_SECTORS
+#define DISK_RD_CACHE_SECTORS 8
+#endif
+
+#if DISK_RD_CACHE_SECTORS
+
+typedef struct {
+    bool valid;
+    LBA_t sector;
+    uint32_t last_used;
+} rd_entry_t;
+
+typedef struct {
+    rd_entry_t entries[DISK_RD_CACHE_SECTORS];
+    BYTE data[DISK_RD_CACHE_SECTORS][FF_MAX_SS];
+    uint32_t clock;
+} rd_cache_t;
+
+// One per drive: FF_MULTI_PARTITION is 0, so pdrv is the volume number
+static rd_cache_t rd_caches[FF_VOLUMES];
+
+static BYTE *rd_data(rd_cache_t *rd, const rd_entry_t *e) {
+    return rd->data[e - rd->entries];
+}
+
+static rd_entry_t *rd_find(rd_cache_t *rd, LBA_t sector) {
+    for (size_t i = 0; i < DISK_RD_CACHE_SECTORS; ++i) {
+        rd_entry_t *e = &rd->entries[i];
+        if (e->valid && e->sector == sector) return e;
+    }
+    return NULL;
+}
+
+// A free entry or else the least recently used one
+static rd_entry_t *rd_victim(rd_cache_t *rd) {
+    rd_entry_t *victim = &rd->entries[0];
+    for (size_t i = 0; i < DISK_RD_CACHE_SECTORS; ++i) {
+        rd_entry_t *e = &rd->entries[i];
+        if (!e->valid) return e;
+        if (e->last_used < victim->last_used) victim = e;
+    }
+    return victim;
+}
+
+static void rd_insert(BYTE pdrv, LBA_t sector, const BYTE *buff) {
+    rd_cache_t *rd = &rd_caches[pdrv];
+    rd_entry_t *e = rd_victim(rd);
+    memcpy(rd_data(rd, e), buff, FF_MAX_SS);
+    e->sector = sector;
+    e->last_used = ++rd->clock;
+    e->valid = true;
+}
+
+// Keeps cached copies in step with sectors being written
+static void rd_update(BYTE pdrv, const BYTE *buff, LBA_t sector, UINT count) {
+    rd_cache_t *rd = &rd_caches[pdrv];
+    for (UINT i = 0; i < count; ++i) {
+        rd_entry_t *e = rd_find(rd, sector + i);
+        if (e) memcpy(rd_data(rd, e), buff + i * FF_MAX_SS, FF_MAX_SS);
+    }
+}
+
+// Forgets cached copies of a drive's sectors that were erased
+static void rd_invalidate(BYTE pdrv, LBA_t sector, LBA_t count) {
+    for (size_t i = 0; i < DISK_RD_CACHE_SECTORS; ++i) {
+        rd_entry_t *e = &rd_caches[pdrv].entries[i];
+        if (e->valid && e->sector - sector < count) e->valid = false;
+    }
+}
+
+#endif
+
+/*-----------------------------------------------------------------------*/
+/* Write-back sector cache                                               */
+/*-----------------------------------------------------------------------*/
+/* Each appended record makes FatFs rewrite the same FAT and directory    */
+/* sectors and the data sector it is filling. Writes are held here until  */
+/* the cache fills or FatFs asks for CTRL_SYNC, so repeated writes to a   */
+/* sector cost one device write, and runs of adjacent sectors go out as   */
+/* multi-block writes. Each drive has its own cache, touched only under  */
+/* its volume's lock, so re-initializing or flushing one card never      */
+/* writes or drops another's sectors. Set DISK_WB_CACHE_SECTORS to 0 to   */
+/* write through.                                                        */
+
+#ifndef DISK_WB_CACHE_SECTORS
+#define DISK_WB_CACHE_SECTORS 8
+#endif
+/* Sectors per coalesced write */
+#if SD_ASYNC_WRITE_ENABLED
+#define DISK_WB_MERGE_MAX SD_ASYNC_BUFFER_BLOCKS
+#else
+#define DISK_WB_MERGE_MAX 4
+#endif
+
+#if FF_FS_READONLY == 0 && DISK_WB_CACHE_SECTORS
+
+typedef struct {
+    bool dirty;
+    LBA_t sector;
+} wb_entry_t;
+
+typedef struct {
+    wb_entry_t entries[DISK_WB_CACHE_SECTORS];
+    BYTE data[DISK_WB_CACHE_SECTORS][FF_MAX_SS];
+} wb_cache_t;
+
+// One per drive: FF_MULTI_PARTITION is 0, so pdrv is the volume number
+static wb_cache_t wb_caches[FF_VOLUMES];
+
+static wb_entry_t *wb_find(wb_cache_t *wb, LBA_t sector) {
+    for (size_t i = 0; i < DISK_WB_CACHE_SECTORS; ++i) {
+        wb_entry_t *e = &wb->entries[i];
+        if (e->dirty && e->sector == sector) return e;
+    }
+    return NULL;
+}
+
+static wb_entry_t *wb_find_free(wb_cache_t *wb) {
+    for (size_t i = 0; i < DISK_WB_CACHE_SECTORS; ++i)
+        if (!wb->entries[i].dirty) return &wb->entries[i];
+    return NULL;
+}
+
+static BYTE *wb_data(wb_cache_t *wb, const wb_entry_t *e) {
+    return wb->data[e - wb->entries];
+}
+
+#endif
+
+#if FF_FS_READONLY == 0
+
+// Hands sectors to the driver: the write-behind queue if they fit,
+// otherwise a synchronous write
+static DRESULT disk_write_through(sd_card_t *p_sd, const BYTE *buff,
+                                  LBA_t sector, UINT count) {
+    ++cache_stats.device_writes;
+#if SD_ASYNC_WRITE_ENABLED
+    if (count <= SD_ASYNC_BUFFER_BLOCKS) {
+        // Write-behind: FatFs may reuse buff as soon as we return, so copy it
+        // into a free buffer and let the card program it in the background.
+        // Errors surface on a later write or on CTRL_SYNC.
+        uint8_t *buffer = sd_write_async_get_buffer(p_sd);
+        memcpy(buffer, buff, count * FF_MAX_SS);
+        int rc = sd_write_async_submit(p_sd, buffer, sector, count);
+        return sdrc2dresult(rc);
+    }
+#endif
+    int rc = p_sd->write_blocks(p_sd, buff, sector, count);
+    return sdrc2dresult(rc);
+}
+
+#endif
+
+#if FF_FS_READONLY == 0 && DISK_WB_CACHE_SECTORS
+
+// Writes out the dirty sectors of a drive, merging runs of adjacent ones
+static DRESULT wb_flush(BYTE pdrv) {
+#if !SD_ASYNC_WRITE_ENABLED
+    static BYTE merged[DISK_WB_MERGE_MAX * FF_MAX_SS];
+#endif
+    sd_card_t *p_sd = sd_get_by_num(pdrv);
+    wb_cache_t *wb = &wb_caches[pdrv];
+    DRESULT res = RES_OK;
+
+    for (;;) {
+        // Lowest dirty sector first
+        size_t first = DISK_WB_CACHE_SECTORS;
+        for (size_t i = 0; i < DISK_WB_CACHE_SECTORS; ++i) {
+            wb_entry_t *e = &wb->entries[i];
+            if (e->dirty && (first == DISK_WB_CACHE_SECTORS ||
+                             e->sector < wb->entries[first].sector))
+                first = i;
+        }
+        if (first == DISK_WB_CACHE_SECTORS) break;
+
+        // Gather the sectors that follow it
+#if SD_ASYNC_WRITE_ENABLED
+        // straight into a write-behind buffer
+        BYTE *merged = sd_write_async_get_buffer(p_sd);
+#endif
+        LBA_t sector = wb->entries[first].sector;
+        UINT count = 0;
+        wb_entry_t *e;
+        while (count < DISK_WB_MERGE_MAX &&
+               (e = wb_find(wb, sector + count)) != NULL) {
+            memcpy(merged + count * FF_MAX_SS, wb_data(wb, e), FF_MAX_SS);
+            e->dirty = false;
+            ++count;
+        }
+        ++cache_stats.device_writes;
+#if SD_ASYNC_WRITE_ENABLED
+        DRESULT rc = sdrc2dresult(sd_write_async_submit(p_sd, merged, sector, count));
+#else
+        DRESULT rc = sdrc2dresult(p_sd->write_blocks(p_sd, merged, sector, count));
+#endif
+        if (RES_OK == res) res = rc;
+    }
+    return res;
+}
+
+#endif
+
+// Drops whatever the caches hold for a drive, pending writes included
+static void cache_forget(BYTE pdrv) {
+#if DISK_RD_CACHE_SECTORS
+    rd_invalidate(pdrv, 0, ~(LBA_t)0);
+#endif
+#if FF_FS_READONLY == 0 && DISK_WB_CACHE_SECTORS
+    for (size_t i = 0; i < DISK_WB_CACHE_SECTORS; ++i)
+        wb_caches[pdrv].entries[i].dirty = false;
+#endif
+    (void)pdrv;
+}
+
 /*-----------------------------------------------------------------------*/
 /* Read Sector(s)                                                        */
 /*-----------------------------------------------------------------------*/
@@ -98,7 +336,40 @@ DRESULT disk_read(BYTE pdrv,  /* Physical drive nmuber to identify the drive */
     TRACE_PRINTF(">>> %s\n", __FUNCTION__);
     sd_card_t *p_sd = sd_get_by_num(pdrv);
     if (!p_sd) return RES_PARERR;
+#if FF_FS_READONLY == 0 && DISK_WB_CACHE_SECTORS
+    // The cache holds the latest contents of its sectors
+    wb_cache_t *wb = &wb_caches[pdrv];
+    wb_entry_t *e;
+    if (1 == count && (e = wb_find(wb, sector)) != NULL) {
+        memcpy(buff, wb_data(wb, e), FF_MAX_SS);
+        ++cache_stats.read_hits;
+        return RES_OK;
+    }
+#endif
+#if DISK_RD_CACHE_SECTORS
+    if (1 == count) {
+        rd_cache_t *rd = &rd_caches[pdrv];
+        rd_entry_t *r = rd_find(rd, sector);
+        if (r) {
+            memcpy(buff, rd_data(rd, r), FF_MAX_SS);
+            r->last_used = ++rd->clock;
+            ++cache_stats.read_hits;
+            return RES_OK;
+        }
+        ++cache_stats.read_misses;
+        int rc = p_sd->read_blocks(p_sd, buff, sector, count);
+        if (SD_BLOCK_DEVICE_ERROR_NONE == rc) rd_insert(pdrv, sector, buff);
+        return sdrc2dresult(rc);
+    }
+#else
+    if (1 == count) ++cache_stats.read_misses;
+#endif
     int rc = p_sd->read_blocks(p_sd, buff, sector, count);
+#if FF_FS_READONLY == 0 && DISK_WB_CACHE_SECTORS
+    for (UINT i = 0; RES_OK == sdrc2dresult(rc) && i < count; ++i)
+        if ((e = wb_find(wb, sector + i)) != NULL)
+            memcpy(buff + i * FF_MAX_SS, wb_data(wb, e), FF_MAX_SS);
+#endif
     return sdrc2dresult(rc);
 }
 
@@ -116,8 +387,37 @@ DRESULT disk_write(BYTE pdrv, /* Physical drive nmuber to identify the drive */
     TRACE_PRINTF(">>> %s\n", __FUNCTION__);
     sd_card_t *p_sd = sd_get_by_num(pdrv);
     if (!p_sd) return RES_PARERR;
-    int rc = p_sd->write_blocks(p_sd, buff, sector, count);
-    return sdrc2dresult(rc);
+    cache_stats.writes += count;
+#if DISK_RD_CACHE_SECTORS
+    rd_update(pdrv, buff, sector, count);
+#endif
+#if DISK_WB_CACHE_SECTORS
+    wb_cache_t *wb = &wb_caches[pdrv];
+    if (count > DISK_WB_CACHE_SECTORS / 2) {
+        // Too big to be worth caching: it supersedes any cached copies
+        for (UINT i = 0; i < count; ++i) {
+            wb_entry_t *e = wb_find(wb, sector + i);
+            if (e) e->dirty = false;
+        }
+        return disk_write_through(p_sd, buff, sector, count);
+    }
+    for (UINT i = 0; i < count; ++i) {
+        wb_entry_t *e = wb_find(wb, sector + i);
+        if (!e) e = wb_find_free(wb);
+        if (!e) {
+            // Full: write everything out and start over
+            DRESULT res = wb_flush(pdrv);
+            if (RES_OK != res) return res;
+            e = wb_find_free(wb);
+        }
+        memcpy(wb_data(wb, e), buff + i * FF_MAX_SS, FF_MAX_SS);
+        e->sector = sector + i;
+        e->dirty = true;
+    }
+    return RES_OK;
+#else
+    return disk_write_through(p_sd, buff, sector, count);
+#endif
 }
 
 #endif
@@ -156,12 +456,49 @@ DRESULT disk_ioctl(BYTE pdrv, /* Physical drive nmuber (0..) */
                                 // f_mkfs function and it attempts to align data
                                 // area on the erase block boundary. It is
                                 // required when FF_USE_MKFS == 1.
-            static DWORD bs = 1;
+            // The allocation unit read from the SD Status, else the CSD erase
+            // sector, reduced to the largest power of 2 dividing it (12 MB and
+            // 24 MB AUs exist) and capped at what FatFs accepts.
+            DWORD bs = p_sd->au_sectors ? p_sd->au_sectors : p_sd->erase_sectors;
+            bs &= -bs;
+            if (!bs) bs = 1;
+            if (bs > 32768) bs = 32768;
             *(DWORD *)buff = bs;
             return RES_OK;
         }
-        case CTRL_SYNC:
-            return RES_OK;
+        case CTRL_SYNC: {
+            DRESULT res = RES_OK;
+#if FF_FS_READONLY == 0 && DISK_WB_CACHE_SECTORS
+            res = wb_flush(pdrv);
+#endif
+#if SD_ASYNC_WRITE_ENABLED
+            // Complete the write-behind queue
+            DRESULT rc = sdrc2dresult(sd_write_async_flush(p_sd));
+            if (RES_OK == res) res = rc;
+#endif
+            return res;
+        }
+#if FF_USE_TRIM
+        case CTRL_TRIM: {  // Informs the device that the data on the block of
+                           // sectors is no longer needed. buff points to an
+                           // LBA_t array {start, end}, both inclusive. FatFs
+                           // issues it for clusters freed by f_unlink and
+                           // f_truncate; the SD card erases them.
+            LBA_t start = ((LBA_t *)buff)[0];
+            LBA_t count = ((LBA_t *)buff)[1] - start + 1;
+#if FF_FS_READONLY == 0 && DISK_WB_CACHE_SECTORS
+            // Pending writes to the range are moot now
+            for (size_t i = 0; i < DISK_WB_CACHE_SECTORS; ++i) {
+                wb_entry_t *e = &wb_caches[pdrv].entries[i];
+                if (e->dirty && e->sector - start < count) e->dirty = false;
+            }
+#endif
+#if DISK_RD_CACHE_SECTORS
+            rd_invalidate(pdrv, start, count);
+#endif
+            return sdrc2dresult(sd_erase_blocks(p_sd, start, count));
+        }
+#endif
         default:
             return RES_PARERR;
     }
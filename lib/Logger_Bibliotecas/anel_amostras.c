@@ -0,0 +1,101 @@
+#include "anel_amostras.h"
+#include <string.h>
+
+_Static_assert((ANEL_AMOSTRAS_CAPACIDADE & (ANEL_AMOSTRAS_CAPACIDADE - 1)) == 0,
+               "a capacidade do anel deve ser potência de 2");
+
+#define CANAIS (sizeof(mpu6050_raw_t) / sizeof(int16_t))
+
+// Grupo (MPU6050_CANAL_*) de cada canal de mpu6050_raw_t
+static const uint8_t GRUPO_DO_CANAL[CANAIS] = {
+    MPU6050_CANAL_ACEL, MPU6050_CANAL_ACEL, MPU6050_CANAL_ACEL,
+    MPU6050_CANAL_TEMP,
+    MPU6050_CANAL_GIRO, MPU6050_CANAL_GIRO, MPU6050_CANAL_GIRO,
+};
+
+uint8_t esquema_canais_da_vez(const esquema_canais_t *esquema, uint32_t leitura) {
+    uint8_t canais = 0;
+    for (uint32_t grupo = 0; grupo < MPU6050_GRUPOS; grupo++) {
+        uint16_t divisor = esquema->divisores[grupo] ? esquema->divisores[grupo] : 1;
+        if (leitura % divisor == 0) canais |= 1u << grupo;
+    }
+    return canais & esquema->canais;
+}
+
+void anel_iniciar(anel_amostras_t *anel) {
+    memset(anel, 0, sizeof(*anel));
+}
+
+uint32_t anel_publicar(anel_amostras_t *anel, const mpu6050_raw_t *raw, uint8_t canais) {
+    uint32_t numero = anel->publicadas + 1;
+    __sync_synchronize(); // A vaga só muda depois de a anterior ser anunciada
+    amostra_anel_t *destino = &anel->amostras[numero & (ANEL_AMOSTRAS_CAPACIDADE - 1)];
+    destino->numero = numero;
+    destino->canais = canais;
+    destino->raw = *raw;
+    __sync_synchronize(); // A amostra fica completa antes de ser anunciada
+    anel->publicadas = numero;
+    return numero;
+}
+
+void anel_leitor_iniciar(const anel_amostras_t *anel, leitor_anel_t *leitor) {
+    leitor->lidas = anel->publicadas;
+    leitor->perdidas = 0;
+}
+
+bool anel_ler(const anel_amostras_t *anel, leitor_anel_t *leitor, amostra_anel_t *amostra) {
+    while (true) {
+        uint32_t publicadas = anel->publicadas;
+        if (leitor->lidas == publicadas) return false;
+
+        // Atrasado demais: pula para a mais antiga que ainda está no anel. A
+        // vaga da mais antiga de todas é a próxima que o produtor escreve,
+        // então ela já conta como perdida.
+        if (publicadas - leitor->lidas > ANEL_AMOSTRAS_CAPACIDADE - 1) {
+            uint32_t mais_antiga = publicadas - ANEL_AMOSTRAS_CAPACIDADE + 2;
+            leitor->perdidas += mais_antiga - 1 - leitor->lidas;
+            leitor->lidas = mais_antiga - 1;
+        }
+
+        uint32_t numero = leitor->lidas + 1;
+        *amostra = anel->amostras[numero & (ANEL_AMOSTRAS_CAPACIDADE - 1)];
+        __sync_synchronize();
+        // Com publicadas chegando a numero + CAPACIDADE - 1, o produtor pode
+        // estar escrevendo numero + CAPACIDADE nesta vaga durante a cópia,
+        // com o número antigo ainda no lugar: a amostra só vale abaixo disso
+        if (amostra->numero == numero && anel->publicadas - numero < ANEL_AMOSTRAS_CAPACIDADE - 1) {
+            leitor->lidas = numero;
+            return true;
+        }
+    }
+}
+
+void decimador_iniciar(decimador_t *decimador, uint16_t fator) {
+    memset(decimador, 0, sizeof(*decimador));
+    decimador->fator = fator ? fator : 1;
+}
+
+bool decimador_acrescentar(decimador_t *decimador, const mpu6050_raw_t *raw, uint8_t canais,
+                           mpu6050_raw_t *media) {
+    const int16_t *valores = (const int16_t *)raw;
+    for (uint32_t c = 0; c < CANAIS; c++) {
+        if (!(canais & GRUPO_DO_CANAL[c])) continue;
+        decimador->somas[c] += valores[c];
+        decimador->contagens[c]++;
+    }
+    if (++decimador->acumuladas < decimador->fator) return false;
+
+    int16_t *saida = (int16_t *)&decimador->anterior;
+    for (uint32_t c = 0; c < CANAIS; c++) {
+        int32_t soma = decimador->somas[c], contagem = decimador->contagens[c];
+        if (contagem) {
+            int32_t metade = contagem / 2;
+            saida[c] = (int16_t)((soma >= 0 ? soma + metade : soma - metade) / contagem);
+        }
+        decimador->somas[c] = 0;
+        decimador->contagens[c] = 0;
+    }
+    decimador->acumuladas = 0;
+    *media = decimador->anterior;
+    return true;
+}
@@ -0,0 +1,84 @@
+#ifndef ANEL_AMOSTRAS_H
+#define ANEL_AMOSTRAS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "mpu6050.h"
+
+// Anel de aquisição: cada leitura do sensor é feita uma vez e publicada aqui,
+// e cada destino (arquivo bruto, CSV, caixa-preta) a consome com o seu
+// próprio leitor, no seu ritmo. Um leitor que atrasa
+// ANEL_AMOSTRAS_CAPACIDADE - 1 amostras ou mais pula as que o produtor pode
+// estar sobrescrevendo e as conta como perdidas.
+//
+// Há um só produtor. Os leitores copiam a amostra e depois conferem se ela
+// não foi sobrescrita durante a cópia, então o produtor pode rodar em uma
+// interrupção ou no outro núcleo sem trava.
+
+#define ANEL_AMOSTRAS_CAPACIDADE 64 // Potência de 2: 1,28 s a 50 Hz
+
+// Quais grupos de canais (MPU6050_CANAL_*) são gravados e de quantas em
+// quantas leituras cada um é lido. Um canal lento (a temperatura muda em
+// minutos) fica fora da maioria das leituras e dos registros. A leitura do
+// sensor só encurta quando o grupo fica numa ponta da rajada (veja
+// mpu6050_read_raw_canais()): com aceleração e giroscópio na mesma leitura
+// a temperatura, que fica entre eles, é lida assim mesmo.
+typedef struct {
+    uint8_t canais;
+    uint16_t divisores[MPU6050_GRUPOS]; // Na ordem dos bits MPU6050_CANAL_*
+} esquema_canais_t;
+
+typedef struct {
+    uint32_t numero;              // 1, 2, 3... desde anel_iniciar()
+    uint8_t canais;               // Grupos lidos nesta leitura; os outros repetem o valor anterior
+    mpu6050_raw_t raw;
+} amostra_anel_t;
+
+typedef struct {
+    amostra_anel_t amostras[ANEL_AMOSTRAS_CAPACIDADE];
+    volatile uint32_t publicadas;
+} anel_amostras_t;
+
+typedef struct {
+    uint32_t lidas;               // Número da última amostra entregue
+    uint32_t perdidas;            // Sobrescritas antes de serem lidas
+} leitor_anel_t;
+
+// Média de blocos de amostras, para um destino mais lento que a aquisição.
+// Somar antes de descartar evita o aliasing de só pegar uma a cada N.
+// Cada canal tem a média só das leituras em que foi lido; um canal sem
+// nenhuma leitura no bloco repete a média anterior.
+typedef struct {
+    int32_t somas[7];             // Na ordem de mpu6050_raw_t
+    uint16_t contagens[7];        // Leituras somadas em cada canal
+    mpu6050_raw_t anterior;       // Última média entregue
+    uint16_t fator;               // Amostras por média
+    uint16_t acumuladas;
+} decimador_t;
+
+// Esvazia o anel; a próxima amostra publicada é a de número 1
+void anel_iniciar(anel_amostras_t *anel);
+
+// Grupos de canais a ler na leitura de número leitura (0, 1, 2... desde o
+// início da sessão). A leitura 0 lê todos os canais do esquema.
+uint8_t esquema_canais_da_vez(const esquema_canais_t *esquema, uint32_t leitura);
+
+// Publica uma leitura do sensor, em que os grupos canais foram lidos, e
+// retorna o seu número
+uint32_t anel_publicar(anel_amostras_t *anel, const mpu6050_raw_t *raw, uint8_t canais);
+
+// Posiciona o leitor na próxima amostra a ser publicada
+void anel_leitor_iniciar(const anel_amostras_t *anel, leitor_anel_t *leitor);
+
+// Entrega a próxima amostra do leitor. Retorna false se não houver nenhuma nova.
+bool anel_ler(const anel_amostras_t *anel, leitor_anel_t *leitor, amostra_anel_t *amostra);
+
+// Começa a decimação com fator amostras por média
+void decimador_iniciar(decimador_t *decimador, uint16_t fator);
+
+// Acumula os grupos canais de uma amostra. Quando completa fator amostras,
+// escreve a média arredondada em media e retorna true.
+bool decimador_acrescentar(decimador_t *decimador, const mpu6050_raw_t *raw, uint8_t canais,
+                           mpu6050_raw_t *media);
+
+#endif // ANEL_AMOSTRAS_H
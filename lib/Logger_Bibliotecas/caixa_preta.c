@@ -0,0 +1,238 @@
+#include "caixa_preta.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+#include "crc.h"
+#include "pico/time.h"
+
+_Static_assert(sizeof(bloco_caixa_preta_t) == CAIXA_PRETA_TAMANHO_BLOCO,
+               "o bloco da caixa-preta deve ocupar exatamente um setor");
+_Static_assert(sizeof(colunas_caixa_preta_t) <= CAIXA_PRETA_DADOS,
+               "as colunas devem caber na área de dados do bloco");
+
+// Posição de um bloco no anel: a sequência 1 fica no bloco 0
+static uint32_t posicao_do_bloco(const caixa_preta_t *cp, uint32_t sequencia) {
+    return (sequencia - 1) % cp->total_blocos;
+}
+
+// Grava um bloco na sua posição do arquivo
+static FRESULT escrever_bloco(caixa_preta_t *cp, uint32_t posicao, const void *bloco) {
+    FRESULT resultado = f_lseek(&cp->arquivo, (FSIZE_t)posicao * CAIXA_PRETA_TAMANHO_BLOCO);
+    if (resultado != FR_OK) return resultado;
+    UINT escritos;
+    resultado = f_write(&cp->arquivo, bloco, CAIXA_PRETA_TAMANHO_BLOCO, &escritos);
+    if (resultado == FR_OK && escritos < CAIXA_PRETA_TAMANHO_BLOCO) resultado = FR_DENIED;
+    return resultado;
+}
+
+// CRC do bloco, do início até o campo crc
+static uint16_t crc_do_bloco(const bloco_caixa_preta_t *bloco) {
+    return crc16((const char *)bloco, offsetof(bloco_caixa_preta_t, crc));
+}
+
+// Começa o bloco da sequência seguinte, vazio
+static void iniciar_bloco(caixa_preta_t *cp) {
+    bloco_caixa_preta_t *bloco = &cp->bloco;
+    bloco->sequencia++;
+    bloco->registros = 0;
+    bloco->tamanho = 0;
+    memset(bloco->dados, 0, sizeof(bloco->dados));
+    delta_iniciar(&cp->codificador, bloco->dados, sizeof(bloco->dados));
+    cp->registros_lz = 0;
+}
+
+// Copia as amostras em espera para entrada_lz, uma coluna por canal.
+// Retorna o número de bytes.
+static uint16_t transpor_lz(caixa_preta_t *cp, uint16_t registros) {
+    int16_t *saida = (int16_t *)cp->entrada_lz;
+    for (uint16_t c = 0; c < CAIXA_PRETA_CANAIS; c++) {
+        for (uint16_t i = 0; i < registros; i++) {
+            *saida++ = ((const int16_t *)&cp->amostras_lz[i])[c];
+        }
+    }
+    return registros * sizeof(mpu6050_raw_t);
+}
+
+// Comprime as amostras do bloco mais esta. Se o resultado não couber, o
+// bloco volta a ter só as anteriores.
+static bool acrescentar_lz(caixa_preta_t *cp, const mpu6050_raw_t *raw) {
+    bloco_caixa_preta_t *bloco = &cp->bloco;
+    if (cp->registros_lz >= sizeof(cp->amostras_lz) / sizeof(cp->amostras_lz[0])) return false;
+    cp->amostras_lz[cp->registros_lz] = *raw;
+
+    int tamanho = lz_compactar(cp->entrada_lz, transpor_lz(cp, cp->registros_lz + 1),
+                               bloco->dados, sizeof(bloco->dados), &cp->tabela_lz);
+    if (tamanho < 0) {
+        // A tentativa sobrescreveu dados[]: refaz a compressão anterior
+        lz_compactar(cp->entrada_lz, transpor_lz(cp, cp->registros_lz),
+                     bloco->dados, sizeof(bloco->dados), &cp->tabela_lz);
+        return false;
+    }
+    cp->registros_lz++;
+    bloco->tamanho = tamanho;
+    return true;
+}
+
+// Coloca a amostra na próxima linha de cada coluna e atualiza os limites
+static bool acrescentar_colunas(caixa_preta_t *cp, const mpu6050_raw_t *raw) {
+    bloco_caixa_preta_t *bloco = &cp->bloco;
+    colunas_caixa_preta_t *colunas = &bloco->colunas;
+    uint16_t linha = bloco->registros;
+    if (linha >= CAIXA_PRETA_REGISTROS_COLUNAS) return false;
+
+    const int16_t *valores = (const int16_t *)raw;
+    for (uint16_t c = 0; c < CAIXA_PRETA_CANAIS; c++) {
+        colunas->canal[c][linha] = valores[c];
+        if (linha == 0 || valores[c] < colunas->minimo[c]) colunas->minimo[c] = valores[c];
+        if (linha == 0 || valores[c] > colunas->maximo[c]) colunas->maximo[c] = valores[c];
+    }
+    bloco->tamanho = sizeof(*colunas); // As colunas têm lugar fixo
+    return true;
+}
+
+// Acrescenta uma amostra ao bloco no formato dele. Retorna false se não couber.
+static bool acrescentar_amostra(caixa_preta_t *cp, const mpu6050_raw_t *raw) {
+    bloco_caixa_preta_t *bloco = &cp->bloco;
+    if (bloco->formato == CAIXA_PRETA_DELTA) {
+        if (!delta_acrescentar(&cp->codificador, raw)) return false;
+        bloco->tamanho = cp->codificador.tamanho;
+    } else if (bloco->formato == CAIXA_PRETA_LZ) {
+        if (!acrescentar_lz(cp, raw)) return false;
+    } else if (bloco->formato == CAIXA_PRETA_COLUNAS) {
+        if (!acrescentar_colunas(cp, raw)) return false;
+    } else {
+        if (bloco->tamanho + sizeof(*raw) > sizeof(bloco->dados)) return false;
+        memcpy(&bloco->dados[bloco->tamanho], raw, sizeof(*raw));
+        bloco->tamanho += sizeof(*raw);
+    }
+    bloco->registros++;
+    return true;
+}
+
+// Lê a sequência gravada em uma posição (0 se o bloco não for válido)
+static uint32_t ler_sequencia(caixa_preta_t *cp, uint32_t posicao) {
+    bloco_caixa_preta_t *bloco = &cp->bloco; // Usa o bloco atual como buffer
+    UINT lidos;
+    if (f_lseek(&cp->arquivo, (FSIZE_t)posicao * CAIXA_PRETA_TAMANHO_BLOCO) != FR_OK ||
+        f_read(&cp->arquivo, bloco, CAIXA_PRETA_TAMANHO_BLOCO, &lidos) != FR_OK ||
+        lidos < CAIXA_PRETA_TAMANHO_BLOCO || bloco->marca != CAIXA_PRETA_MARCA ||
+        bloco->crc != crc_do_bloco(bloco)) {
+        return 0;
+    }
+    return bloco->sequencia;
+}
+
+// Cria o arquivo com espaço contíguo e zera todos os blocos, para que
+// restos de dados antigos do cartão não pareçam blocos válidos
+static FRESULT criar_anel(caixa_preta_t *cp, const char *nome) {
+    FRESULT resultado = f_open(&cp->arquivo, nome, FA_READ | FA_WRITE | FA_CREATE_ALWAYS);
+    if (resultado != FR_OK) return resultado;
+
+    resultado = f_expand(&cp->arquivo, (FSIZE_t)cp->total_blocos * CAIXA_PRETA_TAMANHO_BLOCO, 1);
+    if (resultado == FR_DENIED) resultado = FR_OK; // Sem área contígua: o arquivo cresce ao zerar
+
+    memset(&cp->bloco, 0, sizeof(cp->bloco));
+    for (uint32_t i = 0; resultado == FR_OK && i < cp->total_blocos; i++) {
+        resultado = escrever_bloco(cp, i, &cp->bloco);
+    }
+    if (resultado == FR_OK) resultado = f_sync(&cp->arquivo);
+    if (resultado != FR_OK) f_close(&cp->arquivo);
+    return resultado;
+}
+
+// Encontra o bloco mais novo. O anel é gravado em ordem a partir do bloco 0,
+// então até o mais novo cada posição i guarda a sequência do bloco 0 mais i,
+// e depois dele só há blocos de uma volta anterior ou nunca gravados. Uma
+// busca binária sobre essa propriedade precisa de poucas leituras.
+static uint32_t sequencia_mais_nova(caixa_preta_t *cp) {
+    uint32_t primeira = ler_sequencia(cp, 0);
+    if (primeira == 0) {
+        // A energia caiu enquanto o bloco 0 era gravado: os outros ainda são
+        // da volta anterior, em ordem, e o último deles é o mais novo (0 se o
+        // anel estava na primeira volta, ou seja, vazio)
+        return ler_sequencia(cp, cp->total_blocos - 1);
+    }
+
+    uint32_t ultimo_valido = 0, limite = cp->total_blocos; // Busca em [ultimo_valido, limite)
+    while (limite - ultimo_valido > 1) {
+        uint32_t meio = ultimo_valido + (limite - ultimo_valido) / 2;
+        if (ler_sequencia(cp, meio) == primeira + meio) {
+            ultimo_valido = meio;
+        } else {
+            limite = meio;
+        }
+    }
+    return primeira + ultimo_valido;
+}
+
+// Habilita o fast seek: os saltos pelo anel não percorrem a FAT
+static void habilitar_fast_seek(caixa_preta_t *cp) {
+    cp->tabela_clusters[0] = CAIXA_PRETA_TABELA;
+    cp->arquivo.cltbl = cp->tabela_clusters;
+    if (f_lseek(&cp->arquivo, CREATE_LINKMAP) != FR_OK) {
+        cp->arquivo.cltbl = NULL; // Arquivo fragmentado demais para a tabela
+    }
+}
+
+FRESULT caixa_preta_abrir(caixa_preta_t *cp, const char *nome, uint32_t total_blocos,
+                          uint16_t periodo_ms, formato_caixa_preta_t formato) {
+    memset(cp, 0, sizeof(*cp));
+    cp->total_blocos = total_blocos;
+
+    FSIZE_t tamanho = (FSIZE_t)total_blocos * CAIXA_PRETA_TAMANHO_BLOCO;
+    FRESULT resultado = f_open(&cp->arquivo, nome, FA_READ | FA_WRITE | FA_OPEN_EXISTING);
+    if (resultado == FR_OK && f_size(&cp->arquivo) != tamanho) {
+        printf("Caixa-preta: tamanho diferente, recriando %s\n", nome);
+        f_close(&cp->arquivo);
+        resultado = FR_NO_FILE;
+    }
+    if (resultado == FR_NO_FILE) {
+        resultado = criar_anel(cp, nome);
+    }
+    if (resultado != FR_OK) return resultado;
+
+    habilitar_fast_seek(cp);
+
+    // Continua o anel depois do bloco mais novo
+    uint32_t ultima = sequencia_mais_nova(cp);
+    memset(&cp->bloco, 0, sizeof(cp->bloco));
+    cp->bloco.marca = CAIXA_PRETA_MARCA;
+    cp->bloco.sequencia = ultima;
+    cp->bloco.periodo_ms = periodo_ms;
+    cp->bloco.formato = formato;
+    iniciar_bloco(cp);
+    cp->aberta = true;
+    printf("Caixa-preta: %lu blocos, continuando no bloco %lu\n",
+        (unsigned long)total_blocos, (unsigned long)posicao_do_bloco(cp, cp->bloco.sequencia));
+    return FR_OK;
+}
+
+FRESULT caixa_preta_gravar(caixa_preta_t *cp, uint32_t amostra, const mpu6050_raw_t *raw) {
+    if (!cp->aberta) return FR_INVALID_OBJECT;
+
+    bloco_caixa_preta_t *bloco = &cp->bloco;
+    absolute_time_t inicio = get_absolute_time();
+    if (!acrescentar_amostra(cp, raw)) {
+        // Bloco cheio: começa o próximo, sobrescrevendo o mais antigo do anel
+        iniciar_bloco(cp);
+        acrescentar_amostra(cp, raw);
+    }
+    uint32_t duracao = (uint32_t)absolute_time_diff_us(inicio, get_absolute_time());
+    if (duracao > cp->compactacao_max_us) cp->compactacao_max_us = duracao;
+    if (bloco->registros == 1) bloco->primeira_amostra = amostra;
+    bloco->crc = crc_do_bloco(bloco);
+
+    // O bloco é regravado a cada amostra, então uma queda de energia perde no
+    // máximo as amostras do bloco em andamento (o setor cortado falha no CRC)
+    FRESULT resultado = escrever_bloco(cp, posicao_do_bloco(cp, bloco->sequencia), bloco);
+    if (resultado == FR_OK) resultado = f_sync(&cp->arquivo);
+    return resultado;
+}
+
+FRESULT caixa_preta_fechar(caixa_preta_t *cp) {
+    if (!cp->aberta) return FR_OK;
+    cp->aberta = false;
+    printf("Caixa-preta: compactação levou no máximo %lu us por amostra\n",
+        (unsigned long)cp->compactacao_max_us);
+    return f_close(&cp->arquivo);
+}
@@ -0,0 +1,92 @@
+#ifndef CAIXA_PRETA_H
+#define CAIXA_PRETA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "ff.h"
+#include "mpu6050.h"
+#include "codificador_delta.h"
+#include "compressor_lz.h"
+
+// Modo "caixa-preta": um único arquivo de tamanho fixo, criado uma vez, é
+// gravado em anel bloco a bloco. Cada bloco de 512 bytes (um setor) leva um
+// número de sequência e um CRC, então as últimas horas de dados estão sempre
+// no cartão sem criar, apagar ou aumentar arquivos, e um bloco cortado por
+// queda de energia é reconhecido e descartado. O script
+// plotar_graficos/reconstruir_caixa_preta.py coloca os blocos em ordem.
+
+#define CAIXA_PRETA_MARCA 0x4350504DUL // "MPPC" em little-endian
+#define CAIXA_PRETA_TAMANHO_BLOCO 512
+#define CAIXA_PRETA_DADOS 490          // Bytes de amostras por bloco
+#define CAIXA_PRETA_REGISTROS (CAIXA_PRETA_DADOS / sizeof(mpu6050_raw_t)) // 35 sem compactação
+#define CAIXA_PRETA_CANAIS (sizeof(mpu6050_raw_t) / sizeof(int16_t))      // 7
+// No formato em colunas o mínimo e o máximo de cada canal ocupam o espaço de duas amostras
+#define CAIXA_PRETA_REGISTROS_COLUNAS (CAIXA_PRETA_REGISTROS - 2)         // 33
+#define CAIXA_PRETA_TABELA 32          // Entradas da tabela de fast seek
+
+// Como as amostras são guardadas em dados[]
+typedef enum {
+    CAIXA_PRETA_BRUTO = 0,             // mpu6050_raw_t em sequência
+    CAIXA_PRETA_DELTA = 1,             // Diferenças em varint (codificador_delta.h)
+    CAIXA_PRETA_LZ = 2,                // Canal por canal, comprimidos (compressor_lz.h)
+    CAIXA_PRETA_COLUNAS = 3,           // colunas_caixa_preta_t
+} formato_caixa_preta_t;
+
+// Formato em colunas: os valores de cada canal ficam juntos, na ordem de
+// mpu6050_raw_t, e cada coluna começa sempre no mesmo lugar do bloco. Um
+// programa no computador lê um eixo sem decodificar os outros, e o mínimo e
+// o máximo de cada canal permitem pular blocos inteiros numa busca.
+typedef struct {
+    int16_t minimo[CAIXA_PRETA_CANAIS];
+    int16_t maximo[CAIXA_PRETA_CANAIS];
+    int16_t canal[CAIXA_PRETA_CANAIS][CAIXA_PRETA_REGISTROS_COLUNAS];
+} colunas_caixa_preta_t;
+
+// Formato de um bloco no arquivo (little-endian, como o RP2040)
+typedef struct {
+    uint32_t marca;                    // CAIXA_PRETA_MARCA
+    uint32_t sequencia;                // 1, 2, 3... (0 = bloco nunca gravado)
+    uint32_t primeira_amostra;         // Número da primeira amostra do bloco
+    uint16_t registros;                // Amostras no bloco
+    uint16_t periodo_ms;               // Intervalo entre as amostras
+    uint8_t formato;                   // formato_caixa_preta_t
+    uint8_t reservado;
+    uint16_t tamanho;                  // Bytes usados em dados
+    union {
+        uint8_t dados[CAIXA_PRETA_DADOS];
+        colunas_caixa_preta_t colunas; // Formato CAIXA_PRETA_COLUNAS
+    };
+    uint16_t crc;                      // CRC16 (XMODEM) de todos os campos anteriores
+} bloco_caixa_preta_t;
+
+// Estado do arquivo circular aberto
+typedef struct {
+    FIL arquivo;
+    DWORD tabela_clusters[CAIXA_PRETA_TABELA];
+    uint32_t total_blocos;             // Capacidade do anel
+    bloco_caixa_preta_t bloco;         // Bloco sendo preenchido
+    codificador_delta_t codificador;   // Estado da compactação do bloco
+    // Formato LZ: as amostras do bloco ficam aqui sem compressão e são
+    // comprimidas de novo a cada amostra, já que o bloco é regravado a cada
+    // amostra. Antes de comprimir elas são transpostas para entrada_lz, canal
+    // por canal: valores do mesmo eixo se repetem mais que amostras inteiras.
+    mpu6050_raw_t amostras_lz[LZ_ENTRADA_MAXIMA / sizeof(mpu6050_raw_t)];
+    uint16_t registros_lz;
+    uint8_t entrada_lz[LZ_ENTRADA_MAXIMA];
+    tabela_lz_t tabela_lz;
+    uint32_t compactacao_max_us;       // Maior tempo gasto compactando uma amostra
+    bool aberta;
+} caixa_preta_t;
+
+// Abre (ou cria e pré-aloca) o arquivo circular e encontra onde o anel parou.
+// Os blocos novos são gravados no formato pedido.
+FRESULT caixa_preta_abrir(caixa_preta_t *cp, const char *nome, uint32_t total_blocos,
+                          uint16_t periodo_ms, formato_caixa_preta_t formato);
+
+// Acrescenta uma amostra ao bloco atual e o grava no seu lugar do anel
+FRESULT caixa_preta_gravar(caixa_preta_t *cp, uint32_t amostra, const mpu6050_raw_t *raw);
+
+// Fecha o arquivo circular
+FRESULT caixa_preta_fechar(caixa_preta_t *cp);
+
+#endif // CAIXA_PRETA_H
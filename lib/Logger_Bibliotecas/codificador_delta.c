@@ -0,0 +1,67 @@
+#include "codificador_delta.h"
+#include <string.h>
+
+#define CANAIS 7
+
+// Canais na ordem de mpu6050_raw_t
+static void canais(const mpu6050_raw_t *raw, int16_t valores[CANAIS]) {
+    valores[0] = raw->accel_x;
+    valores[1] = raw->accel_y;
+    valores[2] = raw->accel_z;
+    valores[3] = raw->temp;
+    valores[4] = raw->gyro_x;
+    valores[5] = raw->gyro_y;
+    valores[6] = raw->gyro_z;
+}
+
+// Leva diferenças pequenas de qualquer sinal para números pequenos
+static inline uint16_t zigzag(int16_t valor) {
+    return (uint16_t)((uint16_t)valor << 1) ^ (uint16_t)(valor >> 15);
+}
+
+// Escreve um varint e retorna quantos bytes usou (1 a 3 para 16 bits)
+static inline uint8_t escrever_varint(uint8_t *saida, uint16_t valor) {
+    uint8_t n = 0;
+    while (valor >= 0x80) {
+        saida[n++] = (uint8_t)(valor | 0x80);
+        valor >>= 7;
+    }
+    saida[n++] = (uint8_t)valor;
+    return n;
+}
+
+void delta_iniciar(codificador_delta_t *codificador, uint8_t *dados, uint16_t capacidade) {
+    memset(codificador, 0, sizeof(*codificador));
+    codificador->dados = dados;
+    codificador->capacidade = capacidade;
+}
+
+bool delta_acrescentar(codificador_delta_t *codificador, const mpu6050_raw_t *raw) {
+    int16_t atual[CANAIS];
+    canais(raw, atual);
+    uint8_t codificado[DELTA_MAXIMO_POR_AMOSTRA];
+    uint8_t tamanho = 0;
+
+    if (codificador->registros == 0) {
+        // Quadro-chave: valores inteiros, little-endian
+        for (int i = 0; i < CANAIS; i++) {
+            codificado[tamanho++] = (uint8_t)atual[i];
+            codificado[tamanho++] = (uint8_t)((uint16_t)atual[i] >> 8);
+        }
+    } else {
+        int16_t anterior[CANAIS];
+        canais(&codificador->anterior, anterior);
+        for (int i = 0; i < CANAIS; i++) {
+            // A diferença dá a volta em 16 bits, como a soma do decodificador
+            int16_t diferenca = (int16_t)(uint16_t)(atual[i] - anterior[i]);
+            tamanho += escrever_varint(&codificado[tamanho], zigzag(diferenca));
+        }
+    }
+
+    if (codificador->tamanho + tamanho > codificador->capacidade) return false;
+    memcpy(&codificador->dados[codificador->tamanho], codificado, tamanho);
+    codificador->tamanho += tamanho;
+    codificador->registros++;
+    codificador->anterior = *raw;
+    return true;
+}
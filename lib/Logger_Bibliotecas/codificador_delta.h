@@ -0,0 +1,37 @@
+#ifndef CODIFICADOR_DELTA_H
+#define CODIFICADOR_DELTA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "mpu6050.h"
+
+// Compactação das amostras brutas do MPU6050 para a caixa-preta.
+//
+// Leituras seguidas diferem de poucos LSBs, então cada canal é guardado como
+// a diferença para a amostra anterior. A diferença passa pelo zigzag (0, -1,
+// 1, -2... viram 0, 1, 2, 3...) para que valores pequenos de qualquer sinal
+// fiquem pequenos, e é gravada como varint: 7 bits por byte, com o bit mais
+// alto indicando que há mais um byte. Uma diferença de até ±63 ocupa 1 byte.
+//
+// A primeira amostra do bloco (quadro-chave) vai inteira, 7 int16
+// little-endian, então cada bloco é decodificado sozinho. O decodificador
+// está em plotar_graficos/reconstruir_caixa_preta.py.
+
+#define DELTA_TAMANHO_QUADRO_CHAVE 14 // 7 canais x 2 bytes
+#define DELTA_MAXIMO_POR_AMOSTRA 21   // 7 canais x varint de até 3 bytes
+
+typedef struct {
+    uint8_t *dados;           // Onde as amostras codificadas são escritas
+    uint16_t capacidade;      // Tamanho de dados
+    uint16_t tamanho;         // Bytes já usados
+    uint16_t registros;       // Amostras já codificadas
+    mpu6050_raw_t anterior;   // Base da próxima diferença
+} codificador_delta_t;
+
+// Começa um bloco novo sobre o buffer dados
+void delta_iniciar(codificador_delta_t *codificador, uint8_t *dados, uint16_t capacidade);
+
+// Acrescenta uma amostra. Retorna false, sem alterar nada, se ela não couber.
+bool delta_acrescentar(codificador_delta_t *codificador, const mpu6050_raw_t *raw);
+
+#endif // CODIFICADOR_DELTA_H
@@ -0,0 +1,79 @@
+#include "compressor_lz.h"
+#include <string.h>
+
+#define MINIMO_REPETICAO 4
+#define POSICAO_VAZIA 0xFFFF
+
+// Hash multiplicativo dos 4 bytes seguintes
+static inline uint32_t hash(const uint8_t *p) {
+    uint32_t valor = p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+    return (valor * 2654435761u) >> (32 - LZ_BITS_TABELA);
+}
+
+// Escreve a continuação de um campo de 4 bits que chegou a 15
+static inline int escrever_extra(uint8_t *saida, int o, int capacidade, uint32_t resto) {
+    while (resto >= 255) {
+        if (o >= capacidade) return -1;
+        saida[o++] = 255;
+        resto -= 255;
+    }
+    if (o >= capacidade) return -1;
+    saida[o++] = (uint8_t)resto;
+    return o;
+}
+
+// Escreve uma sequência: literais e, se comprimento > 0, a repetição
+static int escrever_sequencia(uint8_t *saida, int o, int capacidade,
+                              const uint8_t *literais, uint32_t quantidade,
+                              uint16_t distancia, uint32_t comprimento) {
+    if (o >= capacidade) return -1;
+    int controle = o++;
+    uint32_t extra_repeticao = comprimento ? comprimento - MINIMO_REPETICAO : 0;
+    saida[controle] = (uint8_t)(((quantidade < 15 ? quantidade : 15) << 4) |
+                                (extra_repeticao < 15 ? extra_repeticao : 15));
+    if (quantidade >= 15 && (o = escrever_extra(saida, o, capacidade, quantidade - 15)) < 0) {
+        return -1;
+    }
+    if (o + (int)quantidade > capacidade) return -1;
+    memcpy(&saida[o], literais, quantidade);
+    o += quantidade;
+    if (!comprimento) return o;
+
+    if (o + 2 > capacidade) return -1;
+    saida[o++] = (uint8_t)distancia;
+    saida[o++] = (uint8_t)(distancia >> 8);
+    if (extra_repeticao >= 15) o = escrever_extra(saida, o, capacidade, extra_repeticao - 15);
+    return o;
+}
+
+int lz_compactar(const uint8_t *entrada, uint16_t tamanho, uint8_t *saida, uint16_t capacidade,
+                 tabela_lz_t *tabela) {
+    if (tamanho > LZ_ENTRADA_MAXIMA) return -1;
+    memset(tabela->posicoes, 0xFF, sizeof(tabela->posicoes));
+
+    int o = 0;
+    uint16_t posicao = 0, inicio_literais = 0;
+    while (posicao + MINIMO_REPETICAO <= tamanho) {
+        uint32_t h = hash(&entrada[posicao]);
+        uint16_t candidata = tabela->posicoes[h];
+        tabela->posicoes[h] = posicao;
+        if (candidata == POSICAO_VAZIA ||
+            memcmp(&entrada[candidata], &entrada[posicao], MINIMO_REPETICAO) != 0) {
+            posicao++;
+            continue;
+        }
+        uint16_t comprimento = MINIMO_REPETICAO;
+        while (posicao + comprimento < tamanho &&
+               entrada[candidata + comprimento] == entrada[posicao + comprimento]) {
+            comprimento++;
+        }
+        o = escrever_sequencia(saida, o, capacidade, &entrada[inicio_literais],
+                               posicao - inicio_literais, posicao - candidata, comprimento);
+        if (o < 0) return -1;
+        posicao += comprimento;
+        inicio_literais = posicao;
+    }
+    // O que sobrou vai como literais na última sequência
+    return escrever_sequencia(saida, o, capacidade, &entrada[inicio_literais],
+                              tamanho - inicio_literais, 0, 0);
+}
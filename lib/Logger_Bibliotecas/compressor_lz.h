@@ -0,0 +1,33 @@
+#ifndef COMPRESSOR_LZ_H
+#define COMPRESSOR_LZ_H
+
+#include <stdint.h>
+
+// Compressor genérico da família LZ77 para blocos pequenos, no estilo do
+// LZ4: a saída é uma série de sequências, cada uma com um byte de controle
+// (4 bits de quantidade de literais, 4 bits de comprimento da repetição - 4),
+// os literais, e a distância (2 bytes, little-endian) até a repetição.
+// Valores 15 nos campos de 4 bits continuam em bytes extras somados (255 =
+// continua). A última sequência só tem literais.
+//
+// Cada posição da entrada é olhada uma única vez e a tabela de hash guarda só
+// a última ocorrência de cada 4 bytes, então o tempo é proporcional ao tamanho
+// do bloco, sem pior caso escondido. A janela é o próprio bloco (até
+// LZ_ENTRADA_MAXIMA bytes). O descompressor está em
+// plotar_graficos/reconstruir_caixa_preta.py.
+
+#define LZ_ENTRADA_MAXIMA 2048      // Maior bloco de entrada
+#define LZ_BITS_TABELA 9
+#define LZ_TAMANHO_TABELA (1 << LZ_BITS_TABELA)
+
+// Tabela de hash usada durante a compressão (fica com quem chama, 1 KB)
+typedef struct {
+    uint16_t posicoes[LZ_TAMANHO_TABELA];
+} tabela_lz_t;
+
+// Comprime tamanho bytes de entrada em saida. Retorna o tamanho comprimido,
+// ou -1 se não couber em capacidade bytes.
+int lz_compactar(const uint8_t *entrada, uint16_t tamanho, uint8_t *saida, uint16_t capacidade,
+                 tabela_lz_t *tabela);
+
+#endif // COMPRESSOR_LZ_H
@@ -0,0 +1,43 @@
+#include "csv_largura_fixa.h"
+#include <string.h>
+#include "formato_decimal.h"
+
+// Escreve um campo de zeros com o ponto no lugar, seguido do separador
+static char *modelo_campo(char *c, uint8_t largura, uint8_t casas, char separador) {
+    memset(c, '0', largura);
+    if (casas) c[largura - casas - 1] = '.';
+    c[largura] = separador;
+    return c + largura + 1;
+}
+
+void csv_fixo_iniciar(linha_csv_fixa_t *linha) {
+    char *c = modelo_campo(linha->texto, CSV_FIXO_LARGURA_AMOSTRA, 0, ',');
+#define MODELO(coluna, convertido, bruto, grupo, casas, largura) \
+    c = modelo_campo(c, largura, casas, ',');
+    ESQUEMA_REGISTRO(MODELO)
+#undef MODELO
+    c[-1] = '\n'; // O último campo termina a linha
+    *c = '\0';
+}
+
+const char *csv_fixo_preencher(linha_csv_fixa_t *linha, uint32_t amostra,
+                               const mpu6050_data_t *dados) {
+    char *campo = linha->texto;
+    // A amostra é sempre positiva e não passa de 10 dígitos
+    uint32_t restante = amostra;
+    for (char *c = campo + CSV_FIXO_LARGURA_AMOSTRA - 1; c >= campo; c--) {
+        *c = (char)('0' + restante % 10);
+        restante /= 10;
+    }
+    campo += CSV_FIXO_LARGURA_AMOSTRA + 1;
+
+    bool negativo;
+    uint32_t magnitude;
+#define PREENCHER(coluna, convertido, bruto, grupo, casas, largura) \
+    magnitude = decimal_escalar(dados->convertido, casas, &negativo); \
+    decimal_preencher_campo(campo, largura, casas, magnitude, negativo); \
+    campo += (largura) + 1;
+    ESQUEMA_REGISTRO(PREENCHER)
+#undef PREENCHER
+    return linha->texto;
+}
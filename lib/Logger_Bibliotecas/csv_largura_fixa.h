@@ -0,0 +1,39 @@
+#ifndef CSV_LARGURA_FIXA_H
+#define CSV_LARGURA_FIXA_H
+
+#include <stdint.h>
+#include "mpu6050.h"
+#include "esquema_registro.h"
+
+// Linhas CSV de tamanho fixo.
+//
+// Cada campo é completado com zeros até uma largura fixa (o sinal '-', quando
+// há, ocupa o primeiro zero), então todas as linhas têm CSV_FIXO_TAMANHO_LINHA
+// bytes e a amostra k de um arquivo está em
+//     tamanho_do_cabeçalho + (k - primeira_amostra_do_arquivo) * CSV_FIXO_TAMANHO_LINHA
+// sem precisar ler nada antes dela. Exemplo de linha:
+//     0000000042,-009.623,0000.731,0009.944,0000.611,0001.466,-000.023,017.57
+//
+// A linha é montada uma vez com as vírgulas e os pontos no lugar; a cada
+// amostra só os dígitos são reescritos, a partir de inteiros, sem snprintf.
+// Valores fora da largura do campo são saturados no maior valor que cabe.
+// As larguras e casas de cada canal vêm de esquema_registro.h.
+
+#define CSV_FIXO_LARGURA_AMOSTRA 10
+#define CSV_FIXO_SOMAR_CAMPO(coluna, convertido, bruto, grupo, casas, largura) + 1 + (largura)
+// Amostra, cada canal com a sua vírgula e o '\n' (72 bytes com o esquema atual)
+#define CSV_FIXO_TAMANHO_LINHA \
+    (CSV_FIXO_LARGURA_AMOSTRA ESQUEMA_REGISTRO(CSV_FIXO_SOMAR_CAMPO) + 1)
+
+typedef struct {
+    char texto[CSV_FIXO_TAMANHO_LINHA + 1];
+} linha_csv_fixa_t;
+
+// Monta o modelo da linha (vírgulas, pontos e '\n')
+void csv_fixo_iniciar(linha_csv_fixa_t *linha);
+
+// Escreve os dígitos de uma amostra no modelo e retorna o texto da linha
+const char *csv_fixo_preencher(linha_csv_fixa_t *linha, uint32_t amostra,
+                               const mpu6050_data_t *dados);
+
+#endif // CSV_LARGURA_FIXA_H
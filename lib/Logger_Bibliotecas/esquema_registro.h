@@ -0,0 +1,103 @@
+#ifndef ESQUEMA_REGISTRO_H
+#define ESQUEMA_REGISTRO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include "mpu6050.h"
+#include "formato_decimal.h"
+
+// Esquema do registro gravado: uma linha por canal, na ordem das colunas do
+// CSV. Tudo o que depende da lista de canais sai desta tabela: o cabeçalho
+// e as linhas do CSV, o CSV de largura fixa, o empacotamento do fluxo bruto
+// e, no computador, plotar_graficos/esquema_registro.py, que lê este
+// arquivo. Acrescentar um canal é acrescentar uma linha aqui.
+//
+// X(coluna, campo em mpu6050_data_t, campo em mpu6050_raw_t, grupo, casas, largura)
+//   coluna:  nome da coluna no CSV
+//   grupo:   MPU6050_CANAL_* que lê o canal; canais de grupos fora da
+//            máscara não são formatados nem gravados
+//   casas:   casas decimais no CSV
+//   largura: caracteres do campo no CSV de largura fixa
+#define ESQUEMA_REGISTRO(X)                                         \
+    X(Acel_X,      accel_x, accel_x, MPU6050_CANAL_ACEL, 3, 8)      \
+    X(Acel_Y,      accel_y, accel_y, MPU6050_CANAL_ACEL, 3, 8)      \
+    X(Acel_Z,      accel_z, accel_z, MPU6050_CANAL_ACEL, 3, 8)      \
+    X(Giro_X,      gyro_x,  gyro_x,  MPU6050_CANAL_GIRO, 3, 8)      \
+    X(Giro_Y,      gyro_y,  gyro_y,  MPU6050_CANAL_GIRO, 3, 8)      \
+    X(Giro_Z,      gyro_z,  gyro_z,  MPU6050_CANAL_GIRO, 3, 8)      \
+    X(Temperatura, temp_c,  temp,    MPU6050_CANAL_TEMP, 2, 6)
+
+// Número de canais da tabela
+#define ESQUEMA_CONTAR(coluna, convertido, bruto, grupo, casas, largura) + 1
+#define ESQUEMA_CANAIS (0 ESQUEMA_REGISTRO(ESQUEMA_CONTAR))
+
+// As funções abaixo são static inline: chamadas com a máscara de canais
+// constante, o compilador descarta os canais fora dela e cada chamada vira
+// código direto para aquele registro, sem percorrer a tabela.
+
+// Escreve o cabeçalho do CSV ("Amostra,Acel_X,...\n"); retorna o tamanho
+static inline size_t registro_cabecalho_csv(char *destino, size_t tamanho, uint8_t canais) {
+    size_t n = (size_t)snprintf(destino, tamanho, "Amostra");
+#define ESQUEMA_COLUNA(coluna, convertido, bruto, grupo, casas, largura) \
+    if ((canais & (grupo)) && n < tamanho) n += (size_t)snprintf(destino + n, tamanho - n, "," #coluna);
+    ESQUEMA_REGISTRO(ESQUEMA_COLUNA)
+#undef ESQUEMA_COLUNA
+    if (n < tamanho) n += (size_t)snprintf(destino + n, tamanho - n, "\n");
+    return n < tamanho ? n : tamanho - 1; // Cortado: só o que coube
+}
+
+// Formata uma linha do CSV com os canais da máscara (com formato_decimal.h,
+// sem printf); retorna o tamanho. Se destino for pequeno, a linha é cortada
+// no último campo que coube, sem o '\n'.
+static inline size_t registro_formatar_csv(char *destino, size_t tamanho, uint32_t amostra,
+                                           const mpu6050_data_t *dados, uint8_t canais) {
+    if (tamanho < FORMATO_DECIMAL_TAMANHO_MAXIMO) {
+        if (tamanho) destino[0] = '\0';
+        return 0;
+    }
+    char *fim = destino + tamanho;
+    char *saida = decimal_escrever(destino, amostra, false, 0);
+    bool cortada = false;
+#define ESQUEMA_CAMPO(coluna, convertido, bruto, grupo, casas, largura) \
+    if ((canais & (grupo)) && !cortada) { \
+        if (fim - saida > FORMATO_DECIMAL_TAMANHO_MAXIMO) { \
+            *saida++ = ','; \
+            saida = decimal_escrever_float(saida, dados->convertido, casas); \
+        } else { \
+            cortada = true; \
+        } \
+    }
+    ESQUEMA_REGISTRO(ESQUEMA_CAMPO)
+#undef ESQUEMA_CAMPO
+    if (!cortada && fim - saida > 1) {
+        *saida++ = '\n';
+        *saida = '\0';
+    }
+    return saida - destino;
+}
+
+// Bytes ocupados pelos canais da máscara empacotados
+static inline uint16_t registro_tamanho_empacotado(uint8_t canais) {
+    uint16_t n = 0;
+#define ESQUEMA_TAMANHO(coluna, convertido, bruto, grupo, casas, largura) \
+    if (canais & (grupo)) n += sizeof(((mpu6050_raw_t *)0)->bruto);
+    ESQUEMA_REGISTRO(ESQUEMA_TAMANHO)
+#undef ESQUEMA_TAMANHO
+    return n;
+}
+
+// Copia os valores brutos dos canais da máscara, na ordem da tabela e
+// little-endian, para saida; retorna quantos bytes escreveu
+static inline uint16_t registro_empacotar(uint8_t *saida, const mpu6050_raw_t *raw, uint8_t canais) {
+    uint16_t n = 0;
+#define ESQUEMA_EMPACOTAR(coluna, convertido, bruto, grupo, casas, largura) \
+    if (canais & (grupo)) { memcpy(saida + n, &raw->bruto, sizeof(raw->bruto)); n += sizeof(raw->bruto); }
+    ESQUEMA_REGISTRO(ESQUEMA_EMPACOTAR)
+#undef ESQUEMA_EMPACOTAR
+    return n;
+}
+
+#endif // ESQUEMA_REGISTRO_H
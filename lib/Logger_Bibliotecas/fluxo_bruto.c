@@ -0,0 +1,63 @@
+#include "fluxo_bruto.h"
+#include <string.h>
+#include "esquema_registro.h"
+
+_Static_assert(sizeof(bloco_bruto_t) == FLUXO_BRUTO_TAMANHO_BLOCO,
+               "o bloco do fluxo bruto deve ocupar exatamente um setor");
+
+// Bytes que uma amostra com estes grupos ocupa em dados (com o byte da máscara)
+static uint16_t tamanho_registro(uint8_t canais) {
+    return 1 + registro_tamanho_empacotado(canais);
+}
+
+// Grava o bloco atual (mesmo incompleto) e começa um vazio
+static FRESULT gravar_bloco(fluxo_bruto_t *fluxo) {
+    if (fluxo->bloco.registros == 0) return FR_OK;
+    FRESULT resultado = log_escrever(&fluxo->log, &fluxo->bloco, sizeof(fluxo->bloco));
+    fluxo->bloco.registros = 0;
+    fluxo->bloco.tamanho = 0;
+    memset(fluxo->bloco.dados, 0, sizeof(fluxo->bloco.dados));
+    if (resultado == FR_OK && ++fluxo->blocos_sem_sincronizar >= fluxo->blocos_por_sincronizacao) {
+        fluxo->blocos_sem_sincronizar = 0;
+        resultado = log_checkpoint(&fluxo->log, fluxo->ultima_amostra);
+    }
+    return resultado;
+}
+
+FRESULT fluxo_bruto_abrir(fluxo_bruto_t *fluxo, const config_log_t *config,
+                          uint16_t periodo_ms, const esquema_canais_t *esquema,
+                          uint16_t blocos_por_sincronizacao) {
+    memset(&fluxo->bloco, 0, sizeof(fluxo->bloco));
+    fluxo->bloco.periodo_ms = periodo_ms;
+    fluxo->bloco.canais = esquema->canais;
+    memcpy(fluxo->bloco.divisores, esquema->divisores, sizeof(fluxo->bloco.divisores));
+    fluxo->blocos_por_sincronizacao = blocos_por_sincronizacao ? blocos_por_sincronizacao : 1;
+    fluxo->blocos_sem_sincronizar = 0;
+    fluxo->ultima_amostra = 0;
+    return log_abrir(&fluxo->log, config);
+}
+
+FRESULT fluxo_bruto_gravar(fluxo_bruto_t *fluxo, const amostra_anel_t *amostra) {
+    bloco_bruto_t *bloco = &fluxo->bloco;
+    uint8_t canais = amostra->canais & bloco->canais;
+    FRESULT resultado = FR_OK;
+    // Houve perda ou o bloco encheu: o bloco só guarda amostras seguidas
+    if (bloco->registros && (amostra->numero != fluxo->ultima_amostra + 1 ||
+                             bloco->tamanho + tamanho_registro(canais) > sizeof(bloco->dados))) {
+        resultado = gravar_bloco(fluxo);
+    }
+    if (bloco->registros == 0) bloco->primeira_amostra = amostra->numero;
+
+    uint8_t *saida = &bloco->dados[bloco->tamanho];
+    saida[0] = canais;
+    bloco->tamanho += 1 + registro_empacotar(saida + 1, &amostra->raw, canais);
+    bloco->registros++;
+    fluxo->ultima_amostra = amostra->numero;
+    return resultado;
+}
+
+FRESULT fluxo_bruto_fechar(fluxo_bruto_t *fluxo) {
+    FRESULT resultado = gravar_bloco(fluxo);
+    FRESULT resultado_fechar = log_fechar(&fluxo->log);
+    return resultado != FR_OK ? resultado : resultado_fechar;
+}
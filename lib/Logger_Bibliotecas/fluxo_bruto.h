@@ -0,0 +1,62 @@
+#ifndef FLUXO_BRUTO_H
+#define FLUXO_BRUTO_H
+
+#include <stdint.h>
+#include "ff.h"
+#include "mpu6050.h"
+#include "log_rotativo.h"
+#include "anel_amostras.h"
+
+// Fluxo binário com todas as amostras da aquisição, sem conversão, para
+// análise posterior. As amostras são juntadas em blocos de 512 bytes (um
+// setor) e cada bloco cheio é gravado de uma vez, sempre alinhado ao setor
+// (os arquivos não têm cabeçalho e o tamanho máximo deve ser múltiplo de
+// 512). De tempos em tempos os dados são levados ao cartão com
+// log_checkpoint(), que também atualiza o índice de tempo do arquivo.
+// O script plotar_graficos/converter_brutos.py converte os blocos para CSV.
+
+#define FLUXO_BRUTO_TAMANHO_BLOCO 512
+#define FLUXO_BRUTO_DADOS 494
+
+// Formato de um bloco no arquivo (little-endian, como o RP2040). O cabeçalho
+// de cada bloco traz o esquema de canais, então um bloco é lido sozinho.
+//
+// Cada amostra ocupa em dados um byte com os grupos lidos nela
+// (MPU6050_CANAL_*) seguido dos valores desses grupos, int16 na ordem da
+// tabela de esquema_registro.h: só os canais gravados, e só nas leituras em
+// que foram lidos.
+// As amostras de um bloco são consecutivas; um bloco com tamanho = 0 (ou
+// maior que FLUXO_BRUTO_DADOS) é espaço reservado que não chegou a ser gravado.
+typedef struct {
+    uint32_t primeira_amostra;    // Número da primeira amostra do bloco
+    uint16_t registros;           // Amostras no bloco
+    uint16_t periodo_ms;          // Intervalo entre as amostras
+    uint16_t tamanho;             // Bytes usados em dados
+    uint8_t canais;               // Grupos gravados (esquema_canais_t)
+    uint8_t reservado;
+    uint16_t divisores[MPU6050_GRUPOS]; // Um grupo é lido a cada divisor amostras
+    uint8_t dados[FLUXO_BRUTO_DADOS];
+} bloco_bruto_t;
+
+typedef struct {
+    log_rotativo_t log;
+    bloco_bruto_t bloco;          // Bloco sendo preenchido
+    uint16_t blocos_por_sincronizacao;
+    uint16_t blocos_sem_sincronizar;
+    uint32_t ultima_amostra;
+} fluxo_bruto_t;
+
+// Abre a sessão de arquivos do fluxo. A cada blocos_por_sincronizacao blocos
+// gravados, os dados são levados ao cartão.
+FRESULT fluxo_bruto_abrir(fluxo_bruto_t *fluxo, const config_log_t *config,
+                          uint16_t periodo_ms, const esquema_canais_t *esquema,
+                          uint16_t blocos_por_sincronizacao);
+
+// Acrescenta uma amostra; grava o bloco quando ele enche. Uma amostra que
+// não segue a anterior (perdida no anel) começa um bloco novo.
+FRESULT fluxo_bruto_gravar(fluxo_bruto_t *fluxo, const amostra_anel_t *amostra);
+
+// Grava o bloco incompleto e encerra a sessão
+FRESULT fluxo_bruto_fechar(fluxo_bruto_t *fluxo);
+
+#endif // FLUXO_BRUTO_H
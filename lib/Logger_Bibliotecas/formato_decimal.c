@@ -0,0 +1,120 @@
+#include "formato_decimal.h"
+#include <math.h>
+#include <string.h>
+
+static const uint32_t POTENCIAS_DE_10[FORMATO_DECIMAL_CASAS_MAXIMAS + 1] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000,
+};
+
+#if FORMATO_DECIMAL_PARES
+static const char PARES[200] =
+    "00010203040506070809" "10111213141516171819" "20212223242526272829"
+    "30313233343536373839" "40414243444546474849" "50515253545556575859"
+    "60616263646566676869" "70717273747576777879" "80818283848586878889"
+    "90919293949596979899";
+#endif
+
+uint32_t decimal_escalar(float valor, uint8_t casas, bool *negativo) {
+    union { float f; uint32_t u; } bits = { .f = valor };
+    *negativo = bits.u >> 31;
+    int32_t expoente = (bits.u >> 23) & 0xFF;
+    uint64_t mantissa = bits.u & 0x7FFFFF;
+    if (expoente == 0xFF) return mantissa ? 0 : UINT32_MAX; // NaN ou infinito
+    if (expoente) mantissa |= 0x800000;
+    else expoente = 1; // Subnormal
+
+    // valor * 10^casas = mantissa * 10^casas * 2^(expoente - 150), exato em 64 bits
+    uint64_t produto = mantissa * POTENCIAS_DE_10[casas];
+    int32_t deslocamento = 150 - expoente;
+    if (deslocamento <= 0) {
+        if (-deslocamento >= 32 || produto > (UINT32_MAX >> -deslocamento)) return UINT32_MAX;
+        return (uint32_t)(produto << -deslocamento);
+    }
+    if (deslocamento >= 64) return 0;
+
+    uint64_t inteiro = produto >> deslocamento;
+    uint64_t resto = produto & ((1ull << deslocamento) - 1);
+    uint64_t metade = 1ull << (deslocamento - 1);
+    inteiro += resto > metade || (resto == metade && (inteiro & 1)); // Metade para o par
+    return inteiro > UINT32_MAX ? UINT32_MAX : (uint32_t)inteiro;
+}
+
+char *decimal_escrever(char *destino, uint32_t magnitude, bool negativo, uint8_t casas) {
+    // Dígitos da direita para a esquerda, pelo menos casas + 1 (o "0." inicial)
+    char digitos[10];
+    char *d = digitos + sizeof(digitos);
+#if FORMATO_DECIMAL_PARES
+    while (magnitude >= 100) {
+        uint32_t par = (magnitude % 100) * 2;
+        magnitude /= 100;
+        *--d = PARES[par + 1];
+        *--d = PARES[par];
+    }
+    if (magnitude >= 10) {
+        *--d = PARES[magnitude * 2 + 1];
+        *--d = PARES[magnitude * 2];
+    } else {
+        *--d = (char)('0' + magnitude);
+    }
+#else
+    do {
+        *--d = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude);
+#endif
+    uint32_t quantidade = digitos + sizeof(digitos) - d;
+
+    char *saida = destino;
+    if (negativo) *saida++ = '-';
+    if (quantidade > casas) {
+        uint32_t inteiros = quantidade - casas;
+        memcpy(saida, d, inteiros);
+        saida += inteiros;
+        d += inteiros;
+    } else {
+        *saida++ = '0';
+    }
+    if (casas) {
+        *saida++ = '.';
+        for (uint32_t zeros = quantidade < casas ? casas - quantidade : 0; zeros; zeros--) {
+            *saida++ = '0';
+        }
+        uint32_t restantes = digitos + sizeof(digitos) - d;
+        memcpy(saida, d, restantes);
+        saida += restantes;
+    }
+    *saida = '\0';
+    return saida;
+}
+
+char *decimal_escrever_float(char *destino, float valor, uint8_t casas) {
+    if (!isfinite(valor)) {
+        char *saida = destino;
+        if (valor < 0) *saida++ = '-';
+        memcpy(saida, isnan(valor) ? "nan" : "inf", 4);
+        return saida + 3;
+    }
+    bool negativo;
+    uint32_t magnitude = decimal_escalar(valor, casas, &negativo);
+    return decimal_escrever(destino, magnitude, negativo, casas);
+}
+
+void decimal_preencher_campo(char *campo, uint8_t largura, uint8_t casas,
+                             uint32_t magnitude, bool negativo) {
+    uint8_t digitos = largura - (casas ? 1 : 0);
+    // O '-' ocupa o primeiro dígito, também com magnitude 0 (-0.0004 com 3
+    // casas é "-000.000", como o "-0.000" de decimal_escrever)
+    if (negativo) digitos--;
+
+    uint64_t maximo = 1;
+    for (uint8_t i = 0; i < digitos; i++) maximo *= 10;
+    if (magnitude >= maximo) magnitude = (uint32_t)(maximo - 1); // Satura
+
+    char *c = campo + largura - 1;
+    for (uint8_t i = 0; i < digitos; i++, c--) {
+        if (*c == '.') c--;
+        *c = (char)('0' + magnitude % 10);
+        magnitude /= 10;
+    }
+    if (negativo) campo[0] = '-';
+}
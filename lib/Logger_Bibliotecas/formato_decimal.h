@@ -0,0 +1,46 @@
+#ifndef FORMATO_DECIMAL_H
+#define FORMATO_DECIMAL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Números com casas decimais fixas escritos a partir de inteiros, no lugar
+// de snprintf("%.3f"): no M0+ o printf converte o float para double e faz
+// as contas em ponto flutuante por software a cada campo.
+//
+// O valor é primeiro levado a um inteiro na escala das casas (12.3456 com 3
+// casas vira 12346) direto dos bits do float, sem double, arredondando como
+// o printf (metade para o par). Depois os dígitos saem do inteiro, dois por
+// divisão com a tabela de pares "00".."99" (FORMATO_DECIMAL_PARES) ou um por
+// vez sem ela, para economizar os 200 bytes da tabela.
+//
+// A magnitude escalada vai até UINT32_MAX; acima disso é saturada.
+
+#ifndef FORMATO_DECIMAL_PARES
+#define FORMATO_DECIMAL_PARES 1
+#endif
+
+#define FORMATO_DECIMAL_CASAS_MAXIMAS 9
+// Sinal, 10 dígitos, ponto e '\0'
+#define FORMATO_DECIMAL_TAMANHO_MAXIMO 13
+
+// Leva valor à escala de casas decimais, arredondado; retorna a magnitude e
+// o sinal separado, para que -0.0004 com 3 casas continue "-0.000" como no
+// printf. NaN e infinito viram 0 e UINT32_MAX.
+uint32_t decimal_escalar(float valor, uint8_t casas, bool *negativo);
+
+// Escreve magnitude / 10^casas com todas as casas (e o '\0'); retorna o
+// ponteiro para o '\0'. Cabe sempre em FORMATO_DECIMAL_TAMANHO_MAXIMO bytes.
+char *decimal_escrever(char *destino, uint32_t magnitude, bool negativo, uint8_t casas);
+
+// Equivale a sprintf(destino, "%.*f", casas, valor) para valores finitos
+// que cabem na escala; NaN e infinito são escritos "nan" e "inf"
+char *decimal_escrever_float(char *destino, float valor, uint8_t casas);
+
+// Escreve o valor completado com zeros à esquerda em um campo de largura
+// fixa que já tem o ponto no lugar (o '-' ocupa o primeiro zero). O que não
+// cabe é saturado no maior valor do campo.
+void decimal_preencher_campo(char *campo, uint8_t largura, uint8_t casas,
+                             uint32_t magnitude, bool negativo);
+
+#endif // FORMATO_DECIMAL_H
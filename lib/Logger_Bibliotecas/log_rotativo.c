@@ -0,0 +1,599 @@
+#include "log_rotativo.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "crc.h"
+#include "diskio.h"
+
+#define LOG_CHECKPOINT_MARCA 0x4B43504CUL // "LPCK" em little-endian
+#define LOG_CHECKPOINT_SETOR 512
+#define LOG_TAMANHO_LINHA 128
+
+// Registro gravado no arquivo de checkpoint. Ele se alterna entre dois setores
+// (pela paridade da sequência): se a gravação de um for interrompida, o outro
+// continua válido, e o de maior sequência com CRC correto é o que vale.
+typedef struct {
+    uint32_t marca;               // LOG_CHECKPOINT_MARCA
+    uint32_t sequencia;           // Cresce a cada checkpoint
+    uint32_t indice;              // Arquivo sendo gravado
+    uint32_t bytes_validos;       // Tudo antes disto já está no cartão
+    uint32_t ultima_amostra;      // Amostra da última linha dentro de bytes_validos
+    uint16_t aberto;              // 1 enquanto a sessão não for fechada
+    uint16_t crc;                 // CRC16 dos campos anteriores
+} checkpoint_log_t;
+
+// Monta o nome de um arquivo da sessão com a extensão dada, ex.: "dados_MPU_0007.idx"
+static void montar_nome_com_extensao(const config_log_t *config, uint32_t indice,
+                                     const char *extensao, char *nome) {
+    snprintf(nome, LOG_TAMANHO_NOME, "%s%04lu%s", config->prefixo, (unsigned long)indice, extensao);
+}
+
+// Monta o nome do arquivo de um índice, ex.: "dados_MPU_0007.csv"
+static void montar_nome(const config_log_t *config, uint32_t indice, char *nome) {
+    montar_nome_com_extensao(config, indice, config->extensao, nome);
+}
+
+// Procura o maior índice entre os arquivos de sessão já existentes
+static uint32_t maior_indice_existente(const config_log_t *config) {
+    char padrao[LOG_TAMANHO_NOME];
+    snprintf(padrao, sizeof(padrao), "%s*%s", config->prefixo, config->extensao);
+    size_t tamanho_prefixo = strlen(config->prefixo);
+
+    DIR diretorio;
+    FILINFO info;
+    uint32_t maior = 0;
+    FRESULT resultado = f_findfirst(&diretorio, &info, "", padrao);
+    while (resultado == FR_OK && info.fname[0]) {
+        uint32_t indice = strtoul(info.fname + tamanho_prefixo, NULL, 10);
+        if (indice > maior) maior = indice;
+        resultado = f_findnext(&diretorio, &info);
+    }
+    f_closedir(&diretorio);
+    return maior;
+}
+
+// Unidade de alocação (AU) do cartão, em setores. O cartão mantém a
+// velocidade de gravação sequencial quando as escritas preenchem AUs
+// inteiras. GET_BLOCK_SIZE só devolve o valor lido por sd_init(), sem
+// acessar o cartão.
+static uint32_t setores_por_au(const FIL *arquivo) {
+    DWORD setores;
+    if (disk_ioctl(arquivo->obj.fs->pdrv, GET_BLOCK_SIZE, &setores) != RES_OK || !setores) {
+        return 1;
+    }
+    return setores;
+}
+
+// Primeiro setor do cartão ocupado pelo arquivo
+static LBA_t primeiro_setor(const FIL *arquivo) {
+    const FATFS *fs = arquivo->obj.fs;
+    return fs->database + (LBA_t)fs->csize * (arquivo->obj.sclust - 2);
+}
+
+// Setores entre o início do arquivo e o próximo limite de AU (0 se alinhado)
+static uint32_t setores_ate_limite_au(const FIL *arquivo, uint32_t setores_au) {
+    uint32_t resto = (uint32_t)(primeiro_setor(arquivo) % setores_au);
+    return resto ? setores_au - resto : 0;
+}
+
+// Cria um arquivo e reserva para ele espaço contíguo começando em um limite
+// de AU
+static FRESULT criar_arquivo(log_rotativo_t *log, FIL *arquivo, const char *nome) {
+    const config_log_t *config = &log->config;
+    FRESULT resultado = f_open(arquivo, nome, FA_WRITE | FA_CREATE_NEW);
+    if (resultado != FR_OK || !config->tamanho_prealocado) return resultado;
+
+    // Os clusters ficam alocados de vez e o arquivo já nasce com o tamanho
+    // reservado; o que sobrar é cortado por f_truncate() ao fechar. A reserva
+    // tem o tamanho pedido, sem arredondar para AUs inteiras: a sobra seria
+    // liberada, e apagada pelo FatFs (FF_USE_TRIM), nesse f_truncate(), que
+    // roda na troca de arquivo, no caminho da aquisição. Como cada reserva
+    // procura o próximo limite de AU, o resto da AU fica livre do mesmo jeito.
+    if (!log->setores_au) log->setores_au = setores_por_au(arquivo);
+    resultado = f_expand_aligned(arquivo, config->tamanho_prealocado, log->setores_au);
+    if (resultado == FR_DENIED || resultado == FR_INVALID_PARAMETER) {
+        // Sem área alinhada livre, ou com a AU menor que um cluster, a reserva
+        // fica onde f_expand() encontrar espaço contíguo
+        resultado = f_expand(arquivo, config->tamanho_prealocado, 1);
+    }
+    if (resultado == FR_OK && setores_ate_limite_au(arquivo, log->setores_au)) {
+        log->reservas_desalinhadas++;
+        printf("Log: %s não começa em um limite de AU\n", nome);
+    }
+    // Sem área contígua livre o arquivo apenas cresce normalmente
+    if (resultado == FR_DENIED) resultado = FR_OK;
+    if (resultado != FR_OK) {
+        f_close(arquivo);
+        f_unlink(nome);
+    }
+    return resultado;
+}
+
+// Apaga no cartão até maximo setores da reserva do arquivo, continuando de
+// *apagados. Retorna true quando a reserva inteira já foi apagada.
+// Setores já apagados são gravados sem o cartão ter que apagá-los antes, o
+// que encurta a espera depois de cada escrita. Também faz o espaço não
+// gravado ler como 0x00 ou 0xFF em vez de dados velhos.
+static bool apagar_reserva(log_rotativo_t *log, FIL *arquivo, const char *nome,
+                           uint32_t *apagados, uint32_t maximo) {
+    // Um arquivo sem reserva (f_expand sem área contígua) tem tamanho 0
+    uint32_t reserva = (f_size(arquivo) + FF_MIN_SS - 1) / FF_MIN_SS;
+    if (!log->config.apagar_reserva || *apagados >= reserva) return true;
+
+    uint32_t quantidade = reserva - *apagados < maximo ? reserva - *apagados : maximo;
+    // f_trim() trava o volume como as outras funções do FatFs, então pode
+    // rodar junto com a gravação de outro arquivo no mesmo cartão
+    if (f_trim(arquivo, (FSIZE_t)*apagados * FF_MIN_SS, (FSIZE_t)quantidade * FF_MIN_SS) != FR_OK) {
+        // O arquivo continua utilizável, só sem a vantagem do apagamento
+        log->falhas_apagamento++;
+        printf("Log: não foi possível apagar a reserva de %s\n", nome);
+        *apagados = reserva;
+        return true;
+    }
+    *apagados += quantidade;
+    return *apagados >= reserva;
+}
+
+// Escreve o cabeçalho no início do arquivo e o leva ao cartão, junto com a
+// entrada de diretório que aponta para a reserva
+static FRESULT escrever_cabecalho(const config_log_t *config, FIL *arquivo, const char *nome) {
+    FRESULT resultado = FR_OK;
+    if (config->cabecalho) {
+        UINT escritos;
+        resultado = f_write(arquivo, config->cabecalho, strlen(config->cabecalho), &escritos);
+    }
+    if (resultado == FR_OK) resultado = f_sync(arquivo);
+    if (resultado != FR_OK) {
+        f_close(arquivo);
+        f_unlink(nome);
+    }
+    return resultado;
+}
+
+// Corta o espaço pré-alocado além do que foi gravado e fecha o arquivo
+static FRESULT encerrar_arquivo(FIL *arquivo) {
+    FRESULT resultado = f_truncate(arquivo); // Corta na posição atual
+    FRESULT resultado_fechar = f_close(arquivo);
+    return resultado != FR_OK ? resultado : resultado_fechar;
+}
+
+// Lê o checkpoint mais recente. Retorna false se não houver nenhum válido.
+static bool ler_checkpoint(FIL *arquivo, checkpoint_log_t *registro) {
+    bool encontrado = false;
+    for (uint32_t setor = 0; setor < 2; setor++) {
+        checkpoint_log_t lido;
+        UINT lidos;
+        if (f_lseek(arquivo, setor * LOG_CHECKPOINT_SETOR) != FR_OK ||
+            f_read(arquivo, &lido, sizeof(lido), &lidos) != FR_OK || lidos < sizeof(lido) ||
+            lido.marca != LOG_CHECKPOINT_MARCA ||
+            lido.crc != crc16((const char *)&lido, offsetof(checkpoint_log_t, crc))) {
+            continue;
+        }
+        if (!encontrado || lido.sequencia > registro->sequencia) {
+            *registro = lido;
+            encontrado = true;
+        }
+    }
+    return encontrado;
+}
+
+// Grava um checkpoint no setor da sua vez e o leva ao cartão
+static FRESULT escrever_checkpoint(FIL *arquivo, checkpoint_log_t *registro) {
+    registro->marca = LOG_CHECKPOINT_MARCA;
+    registro->crc = crc16((const char *)registro, offsetof(checkpoint_log_t, crc));
+    FRESULT resultado = f_lseek(arquivo, (registro->sequencia & 1) * LOG_CHECKPOINT_SETOR);
+    if (resultado != FR_OK) return resultado;
+    UINT escritos;
+    resultado = f_write(arquivo, registro, sizeof(*registro), &escritos);
+    if (resultado == FR_OK && escritos < sizeof(*registro)) resultado = FR_DENIED;
+    if (resultado == FR_OK) resultado = f_sync(arquivo);
+    return resultado;
+}
+
+// Registra no checkpoint um ponto do arquivo atual
+static FRESULT gravar_checkpoint(log_rotativo_t *log, const entrada_indice_t *ponto,
+                                 bool aberto) {
+    if (!log->checkpoint_aberto) return FR_OK;
+    checkpoint_log_t registro = {
+        .sequencia = ++log->sequencia_checkpoint,
+        .indice = log->indice,
+        .bytes_validos = ponto->deslocamento,
+        .ultima_amostra = ponto->amostra,
+        .aberto = aberto,
+    };
+    return escrever_checkpoint(&log->checkpoint, &registro);
+}
+
+// Cria o índice de tempo do arquivo atual
+static void abrir_indice(log_rotativo_t *log) {
+    if (!log->config.extensao_indice) return;
+    char nome[LOG_TAMANHO_NOME];
+    montar_nome_com_extensao(&log->config, log->indice, log->config.extensao_indice, nome);
+    if (f_open(&log->arquivo_indice, nome, FA_WRITE | FA_CREATE_ALWAYS) != FR_OK) {
+        printf("Log: sem índice, %s não pôde ser criado\n", nome);
+        return;
+    }
+    log->indice_aberto = true;
+}
+
+// Fecha o índice de tempo do arquivo atual
+static FRESULT fechar_indice(log_rotativo_t *log) {
+    if (!log->indice_aberto) return FR_OK;
+    log->indice_aberto = false;
+    return f_close(&log->arquivo_indice);
+}
+
+// Posição atual do arquivo de dados, terminando na amostra dada
+static entrada_indice_t ponto_atual(const log_rotativo_t *log, uint32_t amostra) {
+    entrada_indice_t ponto = {
+        .amostra = amostra,
+        .tempo_ms = (uint32_t)(absolute_time_diff_us(log->inicio_sessao, get_absolute_time()) / 1000),
+        .deslocamento = (uint32_t)f_tell(&log->arquivos[log->atual]),
+    };
+    return ponto;
+}
+
+// Acrescenta um ponto do arquivo de dados ao índice e o leva ao cartão. Deve
+// ser chamada com os dados já sincronizados, já que a entrada aponta para eles.
+static FRESULT indexar(log_rotativo_t *log, const entrada_indice_t *ponto) {
+    if (!log->indice_aberto) return FR_OK;
+    UINT escritos;
+    FRESULT resultado = f_write(&log->arquivo_indice, ponto, sizeof(*ponto), &escritos);
+    if (resultado == FR_OK && escritos < sizeof(*ponto)) resultado = FR_DENIED;
+    if (resultado == FR_OK) resultado = f_sync(&log->arquivo_indice);
+    return resultado;
+}
+
+// Leva ao cartão os dados do arquivo atual e registra no índice e no
+// checkpoint um ponto que já está dentro deles
+static FRESULT registrar_ponto(log_rotativo_t *log, const entrada_indice_t *ponto) {
+    // Os dados precisam estar no cartão antes do checkpoint que os garante
+    FRESULT resultado = f_sync(&log->arquivos[log->atual]);
+    if (resultado != FR_OK) return resultado;
+    log->sincronizado = (uint32_t)f_tell(&log->arquivos[log->atual]);
+    resultado = indexar(log, ponto);
+    if (resultado != FR_OK) return resultado;
+    return gravar_checkpoint(log, ponto, true);
+}
+
+// Registra o ponto anotado pelo último log_checkpoint(). Chamada com o
+// arquivo atual em um limite de lote.
+static FRESULT registrar_pendente(log_rotativo_t *log) {
+    log->checkpoint_pendente = false;
+    return registrar_ponto(log, &log->pendente);
+}
+
+// true enquanto nenhum setor do arquivo atual foi completado depois da última
+// sincronização. Só então a preparação do próximo arquivo pode sincronizar:
+// o f_sync() esvazia o cache de escrita de glue.c e partiria um lote do
+// arquivo atual que estivesse nele.
+static bool logo_apos_sincronizar(const log_rotativo_t *log) {
+    return f_tell(&log->arquivos[log->atual]) / FF_MIN_SS == log->sincronizado / FF_MIN_SS;
+}
+
+// Lê a entrada de número n do índice
+static bool ler_entrada_indice(FIL *arquivo, uint32_t n, entrada_indice_t *entrada) {
+    UINT lidos;
+    return f_lseek(arquivo, (FSIZE_t)n * sizeof(*entrada)) == FR_OK &&
+           f_read(arquivo, entrada, sizeof(*entrada), &lidos) == FR_OK &&
+           lidos == sizeof(*entrada);
+}
+
+// Depois de recuperar um arquivo de dados, descarta do seu índice as entradas
+// que apontam além de onde ele foi cortado (e uma entrada gravada pela metade)
+static void recuperar_indice(const config_log_t *config, uint32_t indice, FSIZE_t fim) {
+    if (!config->extensao_indice) return;
+    char nome[LOG_TAMANHO_NOME];
+    montar_nome_com_extensao(config, indice, config->extensao_indice, nome);
+    FIL arquivo;
+    if (f_open(&arquivo, nome, FA_READ | FA_WRITE | FA_OPEN_EXISTING) != FR_OK) return;
+
+    uint32_t entradas = f_size(&arquivo) / sizeof(entrada_indice_t);
+    entrada_indice_t entrada;
+    while (entradas > 0 && (!ler_entrada_indice(&arquivo, entradas - 1, &entrada) ||
+                            entrada.deslocamento > fim)) {
+        entradas--;
+    }
+    if (f_lseek(&arquivo, (FSIZE_t)entradas * sizeof(entrada_indice_t)) == FR_OK) {
+        f_truncate(&arquivo);
+    }
+    f_close(&arquivo);
+}
+
+// Confere uma linha recuperada: só números, '.', '-' e vírgulas, começando
+// pelo número da amostra. A primeira linha depois do checkpoint só precisa
+// vir depois da última amostra garantida (pode ter havido uma troca de
+// arquivo no meio); as seguintes precisam estar em sequência.
+static bool linha_valida(const char *linha, uint32_t *ultima_amostra, bool primeira) {
+    if (!linha[0]) return false;
+    for (const char *c = linha; *c; c++) {
+        if (!strchr("0123456789.-,", *c)) return false;
+    }
+    char *fim;
+    uint32_t amostra = strtoul(linha, &fim, 10);
+    if (fim == linha || *fim != ',') return false;
+    if (primeira ? amostra <= *ultima_amostra : amostra != *ultima_amostra + 1) return false;
+    *ultima_amostra = amostra;
+    return true;
+}
+
+// Varre o arquivo a partir do checkpoint e retorna onde termina a última
+// linha válida. O lixo do espaço pré-alocado ou uma linha cortada pela queda
+// de energia encerram a varredura.
+static FSIZE_t varrer_linhas(FIL *arquivo, const checkpoint_log_t *checkpoint) {
+    FSIZE_t fim = checkpoint->bytes_validos;
+    if (f_lseek(arquivo, fim) != FR_OK) return fim;
+
+    uint32_t ultima_amostra = checkpoint->ultima_amostra;
+    bool primeira = true;
+    char linha[LOG_TAMANHO_LINHA];
+    size_t tamanho = 0;
+    FSIZE_t posicao = fim;
+    char bloco[LOG_CHECKPOINT_SETOR];
+    while (posicao - checkpoint->bytes_validos < LOG_LIMITE_VARREDURA) {
+        UINT lidos;
+        if (f_read(arquivo, bloco, sizeof(bloco), &lidos) != FR_OK || lidos == 0) break;
+        for (UINT i = 0; i < lidos; i++) {
+            posicao++;
+            if (bloco[i] == '\n') {
+                linha[tamanho] = '\0';
+                if (!linha_valida(linha, &ultima_amostra, primeira)) return fim;
+                primeira = false;
+                fim = posicao;
+                tamanho = 0;
+            } else if (tamanho + 1 < sizeof(linha)) {
+                linha[tamanho++] = bloco[i];
+            } else {
+                return fim; // Linha longa demais: não é um registro
+            }
+        }
+    }
+    return fim;
+}
+
+// Verifica se o próximo registro já deve ir para um arquivo novo
+static bool precisa_trocar(const log_rotativo_t *log, UINT tamanho) {
+    if (log->registros == 0) return false; // Nunca troca um arquivo vazio
+    const FIL *arquivo = &log->arquivos[log->atual];
+    if (log->config.tamanho_maximo &&
+        f_tell(arquivo) + tamanho > log->config.tamanho_maximo) {
+        return true;
+    }
+    if (log->config.duracao_maxima_ms &&
+        absolute_time_diff_us(log->inicio, get_absolute_time()) >=
+            (int64_t)log->config.duracao_maxima_ms * 1000) {
+        return true;
+    }
+    return false;
+}
+
+// Avança um passo na preparação do próximo arquivo. Com esperar, o cabeçalho,
+// que é sincronizado, aguarda logo_apos_sincronizar().
+static FRESULT preparar_proximo(log_rotativo_t *log, bool esperar) {
+    if (!log->aberto) return FR_INVALID_OBJECT;
+    if (log->proximo_pronto) return FR_OK;
+
+    FIL *arquivo = &log->arquivos[log->atual ^ 1];
+    if (!log->proximo_criado) {
+        montar_nome(&log->config, log->indice + 1, log->nome_proximo);
+        FRESULT resultado = criar_arquivo(log, arquivo, log->nome_proximo);
+        if (resultado != FR_OK) return resultado;
+        log->proximo_criado = true;
+        log->apagados_proximo = 0;
+        return FR_OK;
+    }
+    if (!apagar_reserva(log, arquivo, log->nome_proximo, &log->apagados_proximo,
+                        LOG_SETORES_POR_APAGAMENTO)) {
+        return FR_OK;
+    }
+    if (esperar && !logo_apos_sincronizar(log)) return FR_OK;
+    log->proximo_criado = false;
+    FRESULT resultado = escrever_cabecalho(&log->config, arquivo, log->nome_proximo);
+    if (resultado == FR_OK) log->proximo_pronto = true;
+    return resultado;
+}
+
+// Termina de preparar o próximo arquivo de uma vez
+static FRESULT preparar_proximo_inteiro(log_rotativo_t *log) {
+    FRESULT resultado = FR_OK;
+    while (resultado == FR_OK && !log->proximo_pronto) {
+        resultado = preparar_proximo(log, false);
+    }
+    return resultado;
+}
+
+// Passa a gravar no próximo arquivo, que normalmente já está pronto. Se as
+// chamadas a log_preparar_proximo() não bastaram, a preparação termina aqui.
+static FRESULT trocar_arquivo(log_rotativo_t *log) {
+    FRESULT resultado = preparar_proximo_inteiro(log);
+    if (resultado != FR_OK) return resultado;
+
+    resultado = encerrar_arquivo(&log->arquivos[log->atual]);
+    log->atual ^= 1;
+    log->proximo_pronto = false;
+    log->indice++;
+    log->registros = 0;
+    log->inicio = get_absolute_time();
+    // O ponto anotado era do arquivo anterior, que já foi inteiro ao cartão
+    log->checkpoint_pendente = false;
+    strcpy(log->nome, log->nome_proximo);
+    printf("Log: gravando em %s\n", log->nome);
+
+    // O índice e o checkpoint passam a apontar para o arquivo novo, logo após
+    // o cabeçalho, que foi ao cartão na preparação
+    FRESULT resultado_indice = fechar_indice(log);
+    abrir_indice(log);
+    entrada_indice_t inicio = ponto_atual(log, log->ultima_amostra);
+    FRESULT resultado_ponto = registrar_ponto(log, &inicio);
+    if (resultado != FR_OK) return resultado;
+    return resultado_indice != FR_OK ? resultado_indice : resultado_ponto;
+}
+
+// Abre o arquivo de checkpoint, continuando a sequência já gravada nele
+static void abrir_checkpoint(log_rotativo_t *log) {
+    if (!log->config.checkpoint) return;
+    if (f_open(&log->checkpoint, log->config.checkpoint,
+               FA_READ | FA_WRITE | FA_OPEN_ALWAYS) != FR_OK) {
+        printf("Log: sem checkpoint, %s não pôde ser aberto\n", log->config.checkpoint);
+        return;
+    }
+    checkpoint_log_t anterior;
+    if (ler_checkpoint(&log->checkpoint, &anterior)) {
+        log->sequencia_checkpoint = anterior.sequencia;
+    }
+    log->checkpoint_aberto = true;
+}
+
+FRESULT log_abrir(log_rotativo_t *log, const config_log_t *config) {
+    memset(log, 0, sizeof(*log));
+    log->config = *config;
+    log->indice = maior_indice_existente(config) + 1;
+    montar_nome(config, log->indice, log->nome);
+
+    // O primeiro arquivo é apagado de uma vez: a aquisição ainda não começou
+    FRESULT resultado = criar_arquivo(log, &log->arquivos[0], log->nome);
+    if (resultado != FR_OK) return resultado;
+    uint32_t apagados = 0;
+    apagar_reserva(log, &log->arquivos[0], log->nome, &apagados, UINT32_MAX);
+    resultado = escrever_cabecalho(config, &log->arquivos[0], log->nome);
+    if (resultado != FR_OK) return resultado;
+    log->aberto = true;
+    log->inicio = get_absolute_time();
+    log->inicio_sessao = log->inicio;
+    printf("Log: gravando em %s\n", log->nome);
+
+    abrir_indice(log);
+    abrir_checkpoint(log);
+    entrada_indice_t inicio = ponto_atual(log, 0);
+    resultado = registrar_ponto(log, &inicio);
+    if (resultado != FR_OK) return resultado;
+
+    // O próximo também fica pronto antes da aquisição começar
+    return preparar_proximo_inteiro(log);
+}
+
+FRESULT log_preparar_proximo(log_rotativo_t *log) {
+    return preparar_proximo(log, true);
+}
+
+// Grava no arquivo de dados; falta de espaço é um erro
+static FRESULT escrever_no_arquivo(FIL *arquivo, const void *dados, UINT tamanho) {
+    UINT escritos;
+    FRESULT resultado = f_write(arquivo, dados, tamanho, &escritos);
+    if (resultado == FR_OK && escritos < tamanho) resultado = FR_DENIED; // Cartão cheio
+    return resultado;
+}
+
+FRESULT log_escrever(log_rotativo_t *log, const void *dados, UINT tamanho) {
+    if (!log->aberto) return FR_INVALID_OBJECT;
+
+    FRESULT resultado;
+    if (precisa_trocar(log, tamanho)) {
+        resultado = trocar_arquivo(log);
+        if (resultado != FR_OK) return resultado;
+    }
+
+    // Com um checkpoint pendente, a escrita é dividida no próximo limite de
+    // lote, onde os dados vão ao cartão e o ponto anotado é registrado
+    FIL *arquivo = &log->arquivos[log->atual];
+    UINT antes_do_limite = tamanho;
+    bool chega_ao_limite = false;
+    if (log->checkpoint_pendente) {
+        uint32_t falta = LOG_BYTES_POR_LOTE - f_tell(arquivo) % LOG_BYTES_POR_LOTE;
+        if (tamanho >= falta) {
+            antes_do_limite = falta;
+            chega_ao_limite = true;
+        }
+    }
+    resultado = escrever_no_arquivo(arquivo, dados, antes_do_limite);
+    if (resultado == FR_OK && chega_ao_limite) resultado = registrar_pendente(log);
+    if (resultado == FR_OK && antes_do_limite < tamanho) {
+        resultado = escrever_no_arquivo(arquivo, (const uint8_t *)dados + antes_do_limite,
+                                        tamanho - antes_do_limite);
+    }
+    log->registros++;
+    return resultado;
+}
+
+FRESULT log_sincronizar(log_rotativo_t *log) {
+    if (!log->aberto) return FR_INVALID_OBJECT;
+    return f_sync(&log->arquivos[log->atual]);
+}
+
+FRESULT log_checkpoint(log_rotativo_t *log, uint32_t ultima_amostra) {
+    if (!log->aberto) return FR_INVALID_OBJECT;
+    log->ultima_amostra = ultima_amostra;
+    log->pendente = ponto_atual(log, ultima_amostra);
+    log->checkpoint_pendente = true;
+    // Já em um limite de lote, não precisa esperar a próxima escrita
+    if (log->pendente.deslocamento % LOG_BYTES_POR_LOTE == 0) return registrar_pendente(log);
+    return FR_OK;
+}
+
+FRESULT log_recuperar(const config_log_t *config) {
+    if (!config->checkpoint) return FR_OK;
+
+    FIL arquivo_checkpoint;
+    FRESULT resultado = f_open(&arquivo_checkpoint, config->checkpoint,
+                               FA_READ | FA_WRITE | FA_OPEN_EXISTING);
+    if (resultado == FR_NO_FILE) return FR_OK; // Nenhuma sessão gravada ainda
+    if (resultado != FR_OK) return resultado;
+
+    checkpoint_log_t checkpoint;
+    if (!ler_checkpoint(&arquivo_checkpoint, &checkpoint) || !checkpoint.aberto) {
+        return f_close(&arquivo_checkpoint); // A última sessão foi fechada
+    }
+
+    char nome[LOG_TAMANHO_NOME];
+    montar_nome(config, checkpoint.indice, nome);
+    FIL arquivo;
+    resultado = f_open(&arquivo, nome, FA_READ | FA_WRITE | FA_OPEN_EXISTING);
+    if (resultado == FR_OK) {
+        FSIZE_t fim = config->binario ? checkpoint.bytes_validos
+                                      : varrer_linhas(&arquivo, &checkpoint);
+        resultado = f_lseek(&arquivo, fim);
+        if (resultado == FR_OK) resultado = encerrar_arquivo(&arquivo);
+        else f_close(&arquivo);
+        recuperar_indice(config, checkpoint.indice, fim);
+        printf("Log: %s recuperado com %lu bytes\n", nome, (unsigned long)fim);
+    } else if (resultado == FR_NO_FILE) {
+        resultado = FR_OK; // Apagado depois da queda: nada a consertar
+    }
+
+    // O arquivo seguinte, se existir, é o pré-criado que não chegou a ser usado
+    montar_nome(config, checkpoint.indice + 1, nome);
+    f_unlink(nome);
+
+    if (resultado == FR_OK) {
+        checkpoint.sequencia++;
+        checkpoint.aberto = false;
+        resultado = escrever_checkpoint(&arquivo_checkpoint, &checkpoint);
+    }
+    FRESULT resultado_fechar = f_close(&arquivo_checkpoint);
+    return resultado != FR_OK ? resultado : resultado_fechar;
+}
+
+FRESULT log_fechar(log_rotativo_t *log) {
+    if (!log->aberto) return FR_OK;
+
+    FRESULT resultado = encerrar_arquivo(&log->arquivos[log->atual]);
+    // O próximo arquivo, pronto ou ainda sendo preparado, não chegou a ser usado
+    if (log->proximo_pronto || log->proximo_criado) {
+        f_close(&log->arquivos[log->atual ^ 1]);
+        f_unlink(log->nome_proximo);
+        log->proximo_pronto = false;
+        log->proximo_criado = false;
+    }
+    FRESULT resultado_indice = fechar_indice(log);
+    if (resultado == FR_OK) resultado = resultado_indice;
+    // Sessão fechada corretamente: não há nada a recuperar na próxima montagem
+    if (log->checkpoint_aberto) {
+        entrada_indice_t fim = ponto_atual(log, log->ultima_amostra);
+        if (resultado == FR_OK) resultado = gravar_checkpoint(log, &fim, false);
+        f_close(&log->checkpoint);
+        log->checkpoint_aberto = false;
+    }
+    log->aberto = false;
+    return resultado;
+}
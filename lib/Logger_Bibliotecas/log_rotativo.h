@@ -0,0 +1,128 @@
+#ifndef LOG_ROTATIVO_H
+#define LOG_ROTATIVO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "pico/time.h"
+#include "ff.h"
+
+// Bytes varridos depois do checkpoint ao recuperar um arquivo
+#define LOG_LIMITE_VARREDURA (16 * 1024)
+
+// Setores da reserva do próximo arquivo apagados por log_preparar_proximo()
+#define LOG_SETORES_POR_APAGAMENTO 256
+
+// Tamanho máximo do nome de um arquivo de sessão ("dados_MPU_0001.csv")
+#define LOG_TAMANHO_NOME 32
+
+// Os checkpoints só levam os dados ao cartão em múltiplos deste tamanho,
+// contados do início do arquivo. Com a reserva começando em um limite de AU,
+// cada sincronização grava lotes inteiros do cache de escrita de glue.c
+// (DISK_WB_CACHE_SECTORS setores), alinhados no cartão.
+#define LOG_BYTES_POR_LOTE (8 * 512)
+
+// Configuração da rotação dos arquivos de log
+typedef struct {
+    const char *prefixo;          // Início do nome dos arquivos, ex.: "dados_MPU_"
+    const char *extensao;         // Final do nome, ex.: ".csv"
+    const char *cabecalho;        // Escrito no início de cada arquivo (pode ser NULL)
+    uint32_t tamanho_maximo;      // Bytes por arquivo antes de trocar (0 = sem limite)
+    uint32_t duracao_maxima_ms;   // Tempo por arquivo antes de trocar (0 = sem limite)
+    uint32_t tamanho_prealocado;  // Espaço contíguo reservado em cada arquivo novo,
+                                  // começando em um limite de AU do cartão. Não é
+                                  // arredondado para AUs inteiras: a sobra seria
+                                  // apagada no f_truncate() da troca de arquivo
+    bool apagar_reserva;          // Apaga no cartão o espaço reservado antes de gravar:
+                                  // o do primeiro arquivo ao abrir a sessão, o dos
+                                  // seguintes aos poucos, em log_preparar_proximo()
+    const char *checkpoint;       // Arquivo de checkpoint, ex.: "dados_MPU.chk" (NULL = sem)
+    const char *extensao_indice;  // Índice ao lado de cada arquivo, ex.: ".idx" (NULL = sem)
+    bool binario;                 // Registros binários: a recuperação corta no último
+                                  // checkpoint, sem procurar linhas depois dele
+} config_log_t;
+
+// Entrada do índice de tempo. A cada checkpoint o arquivo de índice
+// ("dados_MPU_0007.idx" ao lado de "dados_MPU_0007.csv") ganha uma entrada
+// dizendo onde o arquivo de dados estava. As entradas crescem nos três
+// campos, então uma busca binária encontra de onde começar a ler uma amostra
+// ou um instante sem varrer o arquivo inteiro; de lá até o ponto procurado
+// há no máximo o intervalo entre dois checkpoints. Quem lê o índice é
+// plotar_graficos/recortar_log.py, no computador.
+typedef struct {
+    uint32_t amostra;             // As linhas a partir de deslocamento são de amostras depois desta
+    uint32_t tempo_ms;            // Tempo desde o início da sessão quando a entrada foi gravada
+    uint32_t deslocamento;        // Início de uma linha no arquivo de dados
+} entrada_indice_t;
+
+// Estado de uma sessão de gravação com rotação de arquivos.
+// Os dois arquivos se alternam: um sendo gravado e o próximo, já criado e
+// pré-alocado, esperando a troca.
+//
+// Recuperação após queda de energia: os arquivos pré-alocados já nascem com o
+// tamanho reservado, então o que foi gravado sobrevive, mas o arquivo fica com
+// lixo no final. Em vez de um f_sync a cada registro, log_checkpoint() anota de
+// tempos em tempos até onde vão os dados e o número da última amostra; quando
+// o arquivo chega ao próximo múltiplo de LOG_BYTES_POR_LOTE, os dados vão ao
+// cartão e esse ponto é registrado no arquivo de checkpoint. Ao montar o
+// cartão, log_recuperar() lê o checkpoint, varre no máximo
+// LOG_LIMITE_VARREDURA bytes a partir dali aceitando só linhas completas com
+// amostras em sequência (a primeira coluna) e corta o arquivo depois da
+// última linha válida.
+typedef struct {
+    config_log_t config;
+    FIL arquivos[2];
+    FIL checkpoint;
+    FIL arquivo_indice;           // Índice de tempo do arquivo atual
+    uint8_t atual;                // Posição do arquivo sendo gravado em arquivos[]
+    bool aberto;
+    bool proximo_pronto;
+    bool proximo_criado;          // Próximo arquivo criado, com a reserva sendo apagada
+    uint32_t apagados_proximo;    // Setores da reserva do próximo já apagados
+    uint32_t falhas_apagamento;   // Reservas que o cartão não conseguiu apagar
+    uint32_t reservas_desalinhadas; // Reservas que não começam em um limite de AU
+    uint32_t setores_au;          // AU do cartão, lida ao criar o primeiro arquivo
+    uint32_t indice;              // Índice do arquivo atual
+    uint32_t registros;           // Escritas feitas no arquivo atual
+    absolute_time_t inicio;       // Quando o arquivo atual começou a ser gravado
+    absolute_time_t inicio_sessao;
+    char nome[LOG_TAMANHO_NOME];
+    char nome_proximo[LOG_TAMANHO_NOME];
+    bool checkpoint_aberto;
+    uint32_t sequencia_checkpoint; // Número do último checkpoint gravado
+    uint32_t ultima_amostra;       // Última amostra anotada por log_checkpoint()
+    entrada_indice_t pendente;     // Ponto anotado, à espera do próximo limite de lote
+    bool checkpoint_pendente;
+    uint32_t sincronizado;         // Posição do arquivo atual na última sincronização
+    bool indice_aberto;
+} log_rotativo_t;
+
+// Abre uma nova sessão no arquivo de índice seguinte ao maior já existente
+FRESULT log_abrir(log_rotativo_t *log, const config_log_t *config);
+
+// Grava dados no arquivo atual, trocando de arquivo antes se o limite foi atingido
+FRESULT log_escrever(log_rotativo_t *log, const void *dados, UINT tamanho);
+
+// Garante que os dados gravados até aqui estão no cartão
+FRESULT log_sincronizar(log_rotativo_t *log);
+
+// Anota que os dados até aqui terminam na amostra ultima_amostra. Quando o
+// arquivo chega ao próximo múltiplo de LOG_BYTES_POR_LOTE (já nesta chamada,
+// se estiver em um), os dados vão ao cartão e o ponto anotado é registrado no
+// checkpoint e no índice.
+FRESULT log_checkpoint(log_rotativo_t *log, uint32_t ultima_amostra);
+
+// Conserta o arquivo deixado aberto por uma sessão interrompida (queda de
+// energia, cartão removido). Deve ser chamada logo após montar o cartão.
+FRESULT log_recuperar(const config_log_t *config);
+
+// Avança a preparação do próximo arquivo, um passo curto por chamada: cria e
+// pré-aloca o arquivo, apaga LOG_SETORES_POR_APAGAMENTO setores da reserva ou
+// escreve o cabeçalho. O cabeçalho, que é sincronizado, espera o arquivo
+// atual acabar de ir ao cartão em um limite de lote. Deve ser chamada nos intervalos entre amostras, fora do caminho da
+// aquisição; proximo_pronto indica quando terminou.
+FRESULT log_preparar_proximo(log_rotativo_t *log);
+
+// Encerra a sessão: libera o espaço pré-alocado não usado e apaga o próximo arquivo
+FRESULT log_fechar(log_rotativo_t *log);
+
+#endif // LOG_ROTATIVO_H
@@ -35,9 +35,10 @@ static spi_t spis[] = {  // One for each SPI.
         .mosi_gpio = 19,
         .sck_gpio = 18,
 
+        // Upper limit: sd_init() negotiates the fastest rate the wiring
+        // and card sustain, and falls back on CRC errors.
         // .baud_rate = 1000 * 1000
-        .baud_rate = 1000 * 1000
-        // .baud_rate = 25 * 1000 * 1000 // Actual frequency: 20833333.
+        .baud_rate = 25 * 1000 * 1000 // Actual frequency: 20833333.
     }};
 
 // Hardware Configuration of the SD Card "objects"
@@ -0,0 +1,79 @@
+#include "memoria_estatica.h"
+#include "hardware/sync.h"
+
+#define ALINHAMENTO 8
+#define ALINHAR(n) (((n) + ALINHAMENTO - 1) & ~(size_t)(ALINHAMENTO - 1))
+
+// Um bloco livre guarda, no próprio espaço, o endereço do próximo livre
+typedef union bloco_pool {
+    union bloco_pool *proximo;
+    uint8_t dados[ALINHAR(MEMORIA_POOL_TAMANHO_BLOCO)];
+} bloco_pool_t;
+
+static uint8_t arena[MEMORIA_ARENA_BYTES] __attribute__((aligned(ALINHAMENTO)));
+static bloco_pool_t pool[MEMORIA_POOL_BLOCOS];
+static bloco_pool_t *livres;
+static uint32_t blocos_nunca_usados = MEMORIA_POOL_BLOCOS; // Ainda fora da lista
+static estatisticas_memoria_t estatisticas;
+
+// Trava de hardware compartilhada pelos dois núcleos; não precisa ser
+// inicializada, então serve mesmo antes de main() configurar o resto
+static inline uint32_t travar(void) {
+    return spin_lock_blocking(spin_lock_instance(PICO_SPINLOCK_ID_OS1));
+}
+
+static inline void destravar(uint32_t estado) {
+    spin_unlock(spin_lock_instance(PICO_SPINLOCK_ID_OS1), estado);
+}
+
+void *arena_alocar(size_t tamanho) {
+    void *bloco = NULL;
+    uint32_t estado = travar();
+    if (ALINHAR(tamanho) <= MEMORIA_ARENA_BYTES - estatisticas.arena_usada) {
+        bloco = &arena[estatisticas.arena_usada];
+        estatisticas.arena_usada += ALINHAR(tamanho);
+    } else {
+        estatisticas.falhas++;
+    }
+    destravar(estado);
+    return bloco;
+}
+
+void *pool_alocar(size_t tamanho) {
+    bloco_pool_t *bloco = NULL;
+    uint32_t estado = travar();
+    if (tamanho <= MEMORIA_POOL_TAMANHO_BLOCO) {
+        if (livres) {
+            bloco = livres;
+            livres = bloco->proximo;
+        } else if (blocos_nunca_usados) {
+            // Os blocos entram em uso em ordem, sem montar a lista no início
+            bloco = &pool[MEMORIA_POOL_BLOCOS - blocos_nunca_usados--];
+        }
+    }
+    if (bloco) {
+        if (++estatisticas.pool_em_uso > estatisticas.pool_pico) {
+            estatisticas.pool_pico = estatisticas.pool_em_uso;
+        }
+    } else {
+        estatisticas.falhas++;
+    }
+    destravar(estado);
+    return bloco;
+}
+
+void pool_liberar(void *bloco) {
+    if (!bloco) return;
+    uint32_t estado = travar();
+    bloco_pool_t *liberado = bloco;
+    liberado->proximo = livres;
+    livres = liberado;
+    estatisticas.pool_em_uso--;
+    destravar(estado);
+}
+
+void memoria_obter_estatisticas(estatisticas_memoria_t *saida) {
+    uint32_t estado = travar();
+    *saida = estatisticas;
+    destravar(estado);
+}
@@ -0,0 +1,50 @@
+#ifndef MEMORIA_ESTATICA_H
+#define MEMORIA_ESTATICA_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Memória reservada em tempo de compilação, no lugar do malloc, para que
+// sessões longas não dependam da fragmentação do heap:
+//  - arena: alocações feitas uma vez na inicialização e nunca liberadas
+//    (buffer do display). Cada pedido só avança um ponteiro.
+//  - pool: blocos de tamanho fixo alocados e liberados o tempo todo (buffer
+//    de nomes longos do FatFs). Uma lista de blocos livres dá alocação e
+//    liberação em tempo constante.
+// As duas podem ser usadas pelos dois núcleos.
+
+#ifndef MEMORIA_ARENA_BYTES
+#define MEMORIA_ARENA_BYTES 1536 // Buffer do SSD1306 128x64 (1025 bytes) e folga
+#endif
+
+#ifndef MEMORIA_POOL_TAMANHO_BLOCO
+// Buffer de nomes longos do FatFs com exFAT e FF_MAX_LFN = 255:
+// (FF_MAX_LFN + 1) * 2 + (FF_MAX_LFN + 44) / 15 * 32 = 1120 bytes
+#define MEMORIA_POOL_TAMANHO_BLOCO 1120
+#endif
+
+#ifndef MEMORIA_POOL_BLOCOS
+#define MEMORIA_POOL_BLOCOS 2 // Um por núcleo acessando o cartão
+#endif
+
+// Uso da memória desde o início do programa
+typedef struct {
+    uint32_t arena_usada;          // Bytes da arena já alocados
+    uint32_t pool_em_uso;          // Blocos do pool alocados agora
+    uint32_t pool_pico;            // Maior número de blocos alocados ao mesmo tempo
+    uint32_t falhas;               // Pedidos que não couberam
+} estatisticas_memoria_t;
+
+// Aloca da arena (alinhado a 8 bytes). Retorna NULL se não couber.
+void *arena_alocar(size_t tamanho);
+
+// Aloca um bloco do pool. Retorna NULL se o tamanho passar de
+// MEMORIA_POOL_TAMANHO_BLOCO ou se todos os blocos estiverem em uso.
+void *pool_alocar(size_t tamanho);
+
+// Devolve um bloco ao pool (NULL é ignorado)
+void pool_liberar(void *bloco);
+
+void memoria_obter_estatisticas(estatisticas_memoria_t *estatisticas);
+
+#endif // MEMORIA_ESTATICA_H
@@ -11,13 +11,13 @@ static const uint8_t REG_ACCEL_XOUT_H = 0x3B;
 static const uint8_t REG_GYRO_XOUT_H = 0x43;
 static const uint8_t REG_TEMP_OUT_H = 0x41;
 
-// Fatores de sensibilidade (para a configuração padrão)
+// Fatores de sensibilidade (para a configuração padrão, em mpu6050.h)
 // Aceleração: ±2g -> 16384 LSB/g
 // Giroscópio: ±250°/s -> 131 LSB/°/s
 // A aceleração da gravidade (g) é ~9.81 m/s²
-static const float ACCEL_SENSITIVITY = 16384.0;
-static const float GYRO_SENSITIVITY = 131.0;
-static const float GRAVITY_MS2 = 9.81;
+static const float ACCEL_SENSITIVITY = MPU6050_LSB_POR_G;
+static const float GYRO_SENSITIVITY = MPU6050_LSB_POR_DPS;
+static const float GRAVITY_MS2 = MPU6050_GRAVIDADE_MS2;
 
 // Ponteiro para a instância I2C usada
 static i2c_inst_t *i2c_port;
@@ -43,36 +43,66 @@ void mpu6050_init(i2c_inst_t *i2c) {
     printf("MPU6050 inicializado com sucesso.\n");
 }
 
-// Implementação da função de leitura e conversão de dados
-void mpu6050_read_data(mpu6050_data_t *data) {
+// Posição de cada grupo de canais a partir de ACCEL_XOUT_H e o seu tamanho
+static const uint8_t INICIO_GRUPO[MPU6050_GRUPOS] = {0, 6, 8};
+static const uint8_t TAMANHO_GRUPO[MPU6050_GRUPOS] = {6, 2, 6};
+
+// Implementação da leitura dos valores brutos de alguns grupos
+void mpu6050_read_raw_canais(mpu6050_raw_t *raw, uint8_t canais) {
+    canais &= MPU6050_TODOS_CANAIS;
+    if (!canais) return;
+
+    // A rajada cobre do primeiro ao último grupo pedido. Com aceleração e
+    // giroscópio, os 2 bytes da temperatura no meio vêm junto: pular eles
+    // exigiria uma segunda rajada, com outro endereço, registrador e
+    // reinício, que custa mais que os 2 bytes economizados.
+    uint8_t primeiro = 0, ultimo = MPU6050_GRUPOS - 1;
+    while (!(canais & (1u << primeiro))) primeiro++;
+    while (!(canais & (1u << ultimo))) ultimo--;
+    uint8_t inicio = INICIO_GRUPO[primeiro];
+    uint8_t tamanho = INICIO_GRUPO[ultimo] + TAMANHO_GRUPO[ultimo] - inicio;
+
     uint8_t buffer[14];
-    
-    // Inicia a leitura a partir do registrador de aceleração (0x3B)
-    // O MPU6050 auto-incrementa o endereço, então podemos ler tudo de uma vez
-    uint8_t start_reg = REG_ACCEL_XOUT_H;
+    // O MPU6050 auto-incrementa o endereço, então o trecho é lido de uma vez
+    uint8_t start_reg = REG_ACCEL_XOUT_H + inicio;
     i2c_write_blocking(i2c_port, MPU6050_ADDR, &start_reg, 1, true); // true para manter o controle do barramento
-    i2c_read_blocking(i2c_port, MPU6050_ADDR, buffer, 14, false);
-
-    // 1. Extrai e combina os bytes para formar os valores brutos (int16_t)
-    int16_t raw_ax = (buffer[0] << 8) | buffer[1];
-    int16_t raw_ay = (buffer[2] << 8) | buffer[3];
-    int16_t raw_az = (buffer[4] << 8) | buffer[5];
-    int16_t raw_temp = (buffer[6] << 8) | buffer[7];
-    int16_t raw_gx = (buffer[8] << 8) | buffer[9];
-    int16_t raw_gy = (buffer[10] << 8) | buffer[11];
-    int16_t raw_gz = (buffer[12] << 8) | buffer[13];
-
-    // 2. Converte os valores brutos para unidades físicas
+    i2c_read_blocking(i2c_port, MPU6050_ADDR, buffer, tamanho, false);
+
+    // Extrai e combina os bytes dos grupos pedidos (campos na ordem dos registradores)
+    int16_t *campos = (int16_t *)raw;
+    for (uint8_t grupo = primeiro; grupo <= ultimo; grupo++) {
+        if (!(canais & (1u << grupo))) continue;
+        for (uint8_t i = 0; i < TAMANHO_GRUPO[grupo]; i += 2) {
+            const uint8_t *bytes = &buffer[INICIO_GRUPO[grupo] - inicio + i];
+            campos[(INICIO_GRUPO[grupo] + i) / 2] = (int16_t)((bytes[0] << 8) | bytes[1]);
+        }
+    }
+}
+
+// Implementação da leitura dos valores brutos
+void mpu6050_read_raw(mpu6050_raw_t *raw) {
+    mpu6050_read_raw_canais(raw, MPU6050_TODOS_CANAIS);
+}
+
+// Implementação da conversão para unidades físicas
+void mpu6050_convert(const mpu6050_raw_t *raw, mpu6050_data_t *data) {
     // Aceleração: LSB -> g -> m/s²
-    data->accel_x = (raw_ax / ACCEL_SENSITIVITY) * GRAVITY_MS2;
-    data->accel_y = (raw_ay / ACCEL_SENSITIVITY) * GRAVITY_MS2;
-    data->accel_z = (raw_az / ACCEL_SENSITIVITY) * GRAVITY_MS2;
+    data->accel_x = (raw->accel_x / ACCEL_SENSITIVITY) * GRAVITY_MS2;
+    data->accel_y = (raw->accel_y / ACCEL_SENSITIVITY) * GRAVITY_MS2;
+    data->accel_z = (raw->accel_z / ACCEL_SENSITIVITY) * GRAVITY_MS2;
 
     // Giroscópio: LSB -> °/s
-    data->gyro_x = raw_gx / GYRO_SENSITIVITY;
-    data->gyro_y = raw_gy / GYRO_SENSITIVITY;
-    data->gyro_z = raw_gz / GYRO_SENSITIVITY;
+    data->gyro_x = raw->gyro_x / GYRO_SENSITIVITY;
+    data->gyro_y = raw->gyro_y / GYRO_SENSITIVITY;
+    data->gyro_z = raw->gyro_z / GYRO_SENSITIVITY;
 
    // Temperatura: usa a fórmula do datasheet com correção de calibração
-    data->temp_c = (raw_temp / 340.0) + 36.53 - 24.0;
+    data->temp_c = (raw->temp / (double)MPU6050_TEMP_LSB_POR_C) + MPU6050_TEMP_OFFSET_C + MPU6050_TEMP_CALIBRACAO_C;
+}
+
+// Implementação da função de leitura e conversão de dados
+void mpu6050_read_data(mpu6050_data_t *data) {
+    mpu6050_raw_t raw;
+    mpu6050_read_raw(&raw);
+    mpu6050_convert(&raw, data);
 }
@@ -10,10 +10,46 @@ typedef struct {
     float temp_c;
 } mpu6050_data_t;
 
+// Valores brutos dos registradores, na ordem em que o sensor os entrega
+typedef struct {
+    int16_t accel_x, accel_y, accel_z;
+    int16_t temp;
+    int16_t gyro_x, gyro_y, gyro_z;
+} mpu6050_raw_t;
+
+// Grupos de canais, na ordem dos registradores a partir de ACCEL_XOUT_H (0x3B)
+#define MPU6050_CANAL_ACEL 0x01 // accel_x, accel_y, accel_z (6 bytes)
+#define MPU6050_CANAL_TEMP 0x02 // temp (2 bytes)
+#define MPU6050_CANAL_GIRO 0x04 // gyro_x, gyro_y, gyro_z (6 bytes)
+#define MPU6050_TODOS_CANAIS 0x07
+#define MPU6050_GRUPOS 3
+
+// Escalas da configuração padrão (o sensor não é reconfigurado no init) e
+// constantes da conversão, também gravadas no cabeçalho dos arquivos CSV
+#define MPU6050_FAIXA_ACEL_G 2         // ±2g
+#define MPU6050_LSB_POR_G 16384
+#define MPU6050_FAIXA_GIRO_DPS 250     // ±250°/s
+#define MPU6050_LSB_POR_DPS 131
+#define MPU6050_GRAVIDADE_MS2 9.81
+#define MPU6050_TEMP_LSB_POR_C 340
+#define MPU6050_TEMP_OFFSET_C 36.53    // Do datasheet
+#define MPU6050_TEMP_CALIBRACAO_C -24.0 // Correção medida nesta placa
+
 // Inicializa o sensor MPU6050, configurando-o e tirando-o do modo de suspensão
 void mpu6050_init(i2c_inst_t *i2c);
 
 // Lê os dados brutos do MPU6050, converte para unidades padrão e preenche a estrutura fornecida
 void mpu6050_read_data(mpu6050_data_t *data);
 
+// Lê os valores brutos do MPU6050, sem conversão
+void mpu6050_read_raw(mpu6050_raw_t *raw);
+
+// Lê só os grupos de canais pedidos (MPU6050_CANAL_*), em uma única rajada
+// que vai do primeiro ao último registrador necessário. Os campos dos outros
+// grupos ficam como estavam.
+void mpu6050_read_raw_canais(mpu6050_raw_t *raw, uint8_t canais);
+
+// Converte valores brutos para unidades padrão (m/s², °/s e °C)
+void mpu6050_convert(const mpu6050_raw_t *raw, mpu6050_data_t *data);
+
 #endif // MPU6050_H
\ No newline at end of file
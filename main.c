@@ -9,7 +9,17 @@
 #include "f_util.h"
 #include "hw_config.h"
 #include "sd_card.h"
+#include "disk_cache.h"
+#include "ff_mutex_stats.h"
+#include "memoria_estatica.h"
 #include "mpu6050.h" // biblioteca Mpu para falicitar a chamada das conversões
+#include "log_rotativo.h"
+#include "esquema_registro.h"
+#include "csv_largura_fixa.h"
+#include "formato_decimal.h"
+#include "anel_amostras.h"
+#include "fluxo_bruto.h"
+#include "caixa_preta.h"
 #include "ssd1306.h"
 
 // CONFIGURAÇÕES DE HARDWARE - Definem quais pinos usar
@@ -38,8 +48,59 @@
 // Pino do buzzer
 #define BUZZER_PIN 10 // Buzzer conectado no pino 10
 
-// Configurações de tempo
-#define TEMPO_ENTRE_LEITURAS_MS 500 // 500 ms entre cada medição
+// Configurações de tempo. O sensor é lido uma vez por período de aquisição,
+// por um timer, e cada leitura vai para o anel de aquisição, de onde o loop
+// principal tira dois fluxos: todas as leituras para o fluxo bruto e a média
+// de cada DECIMACAO leituras para o CSV (ou a caixa-preta).
+#define PERIODO_AQUISICAO_MS 20 // 50 Hz
+#define DECIMACAO 25
+#define TEMPO_ENTRE_LEITURAS_MS (PERIODO_AQUISICAO_MS * DECIMACAO) // 500 ms entre cada registro
+
+// Canais gravados (grupos MPU6050_CANAL_*) e de quantas em quantas leituras
+// cada grupo é lido. Os arquivos guardam só os canais gravados, e cada
+// leitura só os grupos da vez. No barramento, com aceleração e giroscópio
+// juntos, a rajada continua com os 14 bytes, temperatura incluída.
+#define CANAIS_GRAVADOS MPU6050_TODOS_CANAIS
+#define DIVISOR_ACEL 1  // 50 Hz
+#define DIVISOR_GIRO 1  // 50 Hz
+#define DIVISOR_TEMP 50 // 1 Hz
+
+// Rotação dos arquivos de dados: cada sessão de gravação vai para um novo
+// dados_MPU_NNNN.csv, que é trocado ao atingir o tamanho ou a duração máxima
+#define TAMANHO_MAXIMO_ARQUIVO (1024 * 1024) // 1 MB por arquivo
+#define DURACAO_MAXIMA_ARQUIVO_MS (60 * 60 * 1000) // 1 hora por arquivo
+// As amostras não são sincronizadas uma a uma: a cada checkpoint os dados vão
+// para o cartão e o dados_MPU.chk anota até onde estão garantidos. Uma queda
+// de energia perde no máximo as amostras desde o último checkpoint.
+#define AMOSTRAS_POR_CHECKPOINT 20 // 10 s a 2 Hz
+// Com largura fixa todas as linhas do CSV têm o mesmo tamanho, completadas
+// com zeros, e a amostra k é achada por conta, sem ler o arquivo até ela
+#define CSV_LARGURA_FIXA 0 // 1 = linhas de CSV_FIXO_TAMANHO_LINHA bytes
+#if CSV_LARGURA_FIXA && CANAIS_GRAVADOS != MPU6050_TODOS_CANAIS
+#error "CSV_LARGURA_FIXA grava sempre todos os canais"
+#endif
+// Identificação do firmware no cabeçalho dos CSVs (o CMake passa o commit do git)
+#ifndef VERSAO_FIRMWARE
+#define VERSAO_FIRMWARE __DATE__ " " __TIME__
+#endif
+
+// Fluxo bruto: todas as leituras, sem conversão, em brutos_MPU_NNNN.bin
+// (plotar_graficos/converter_brutos.py converte para CSV)
+#define FLUXO_BRUTO 1 // 0 = grava só os registros decimados
+#define BLOCOS_POR_SINCRONIZACAO 8 // 288 leituras, ~5,8 s a 50 Hz
+
+// Modo caixa-preta: em vez dos CSVs, grava as amostras brutas em anel em um
+// único arquivo de tamanho fixo, que guarda sempre as últimas horas
+#define MODO_CAIXA_PRETA 0 // 1 = grava em caixa_preta.bin
+#if MODO_CAIXA_PRETA && FLUXO_BRUTO
+#error "MODO_CAIXA_PRETA grava só o anel, sem criar nem trocar arquivos: use FLUXO_BRUTO 0"
+#endif
+#define BLOCOS_CAIXA_PRETA 8192 // 4 MB = 8192 blocos de 35 amostras sem compactação (~40 h a 2 Hz)
+// Formato dos blocos: CAIXA_PRETA_BRUTO, CAIXA_PRETA_DELTA (diferenças em
+// varint, melhor para amostras próximas), CAIXA_PRETA_LZ (compressor
+// genérico) ou CAIXA_PRETA_COLUNAS (um canal inteiro lido sem os outros).
+// plotar_graficos/avaliar_compressao.py compara os quatro.
+#define FORMATO_CAIXA_PRETA CAIXA_PRETA_DELTA
 #define TEMPO_DEBOUNCE_US 300000 // Evita múltiplos cliques nos botões
 #define TEMPO_ATUALIZACAO_VALORES_MS 500 // Atualiza valores dos sensores na tela
 
@@ -77,8 +138,52 @@ typedef enum {
 // Estados principais do sistema
 static bool esta_gravando = false;
 static bool cartao_sd_conectado = false;
-static absolute_time_t proxima_medicao;
+static repeating_timer_t timer_aquisicao; // Lê o sensor enquanto grava
 static uint32_t contador_amostras = 0;
+static anel_amostras_t anel_aquisicao;
+static leitor_anel_t leitor_registros; // Leituras que viram registros do CSV ou da caixa-preta
+static decimador_t decimador;
+static const esquema_canais_t esquema_canais = {
+    .canais = CANAIS_GRAVADOS,
+    .divisores = {DIVISOR_ACEL, DIVISOR_TEMP, DIVISOR_GIRO}, // Na ordem dos bits
+};
+static uint32_t leituras_da_sessao = 0;
+static mpu6050_raw_t ultima_leitura; // Canais fora da leitura repetem o último valor
+#if FLUXO_BRUTO
+static leitor_anel_t leitor_bruto;
+static fluxo_bruto_t fluxo_bruto;
+static const config_log_t config_log_brutos = {
+    .prefixo = "brutos_MPU_",
+    .extensao = ".bin",
+    .tamanho_maximo = TAMANHO_MAXIMO_ARQUIVO, // Múltiplo de 512: os blocos ficam alinhados
+    .duracao_maxima_ms = DURACAO_MAXIMA_ARQUIVO_MS,
+    .tamanho_prealocado = TAMANHO_MAXIMO_ARQUIVO,
+    .apagar_reserva = true,
+    .checkpoint = "brutos_MPU.chk",
+    .extensao_indice = ".idx",
+    .binario = true,
+};
+#endif
+#if MODO_CAIXA_PRETA
+static caixa_preta_t caixa_preta;
+#else
+static log_rotativo_t log_dados;
+static char cabecalho_csv[640]; // Montado por montar_cabecalho_csv()
+#if CSV_LARGURA_FIXA
+static linha_csv_fixa_t linha_fixa;
+#endif
+static const config_log_t config_log_dados = {
+    .prefixo = "dados_MPU_",
+    .extensao = ".csv",
+    .cabecalho = cabecalho_csv, // Descrição da sessão e colunas dos canais gravados
+    .tamanho_maximo = TAMANHO_MAXIMO_ARQUIVO,
+    .duracao_maxima_ms = DURACAO_MAXIMA_ARQUIVO_MS,
+    .tamanho_prealocado = TAMANHO_MAXIMO_ARQUIVO,
+    .apagar_reserva = true,
+    .checkpoint = "dados_MPU.chk",
+    .extensao_indice = ".idx",
+};
+#endif
 
 // Controle das telas do display
 static tipo_tela_t tela_atual = TELA_PRINCIPAL;
@@ -308,6 +413,13 @@ static void mostrar_tela_principal(void) {
     ssd1306_send_data(&display_oled);
 }
 
+// Escreve "rótulo" seguido do valor com 2 casas, sem printf
+static void formatar_valor_tela(char *linha, const char *rotulo, float valor) {
+    size_t tamanho_rotulo = strlen(rotulo);
+    memcpy(linha, rotulo, tamanho_rotulo);
+    decimal_escrever_float(linha + tamanho_rotulo, valor, 2);
+}
+
 // Mostra a tela com os valores atuais dos sensores
 static void mostrar_tela_valores_sensores(void) {
     // Limpa toda a tela
@@ -320,27 +432,27 @@ static void mostrar_tela_valores_sensores(void) {
     char linha[30];
     int y = 10;  // Posição inicial vertical
 
-    snprintf(linha, sizeof(linha), "ax: %.2f", dados_sensor_atuais.accel_x);
+    formatar_valor_tela(linha, "ax: ", dados_sensor_atuais.accel_x);
     ssd1306_draw_string(&display_oled, linha, 0, y, false);
     y += 9;
 
-    snprintf(linha, sizeof(linha), "ay: %.2f", dados_sensor_atuais.accel_y);
+    formatar_valor_tela(linha, "ay: ", dados_sensor_atuais.accel_y);
     ssd1306_draw_string(&display_oled, linha, 0, y, false);
     y += 9;
 
-    snprintf(linha, sizeof(linha), "az: %.2f", dados_sensor_atuais.accel_z);
+    formatar_valor_tela(linha, "az: ", dados_sensor_atuais.accel_z);
     ssd1306_draw_string(&display_oled, linha, 0, y, false);
     y += 9;
 
-    snprintf(linha, sizeof(linha), "gx: %.2f", dados_sensor_atuais.gyro_x);
+    formatar_valor_tela(linha, "gx: ", dados_sensor_atuais.gyro_x);
     ssd1306_draw_string(&display_oled, linha, 0, y, false);
     y += 9;
 
-    snprintf(linha, sizeof(linha), "gy: %.2f", dados_sensor_atuais.gyro_y);
+    formatar_valor_tela(linha, "gy: ", dados_sensor_atuais.gyro_y);
     ssd1306_draw_string(&display_oled, linha, 0, y, false);
     y += 9;
 
-    snprintf(linha, sizeof(linha), "gz: %.2f", dados_sensor_atuais.gyro_z);
+    formatar_valor_tela(linha, "gz: ", dados_sensor_atuais.gyro_z);
     ssd1306_draw_string(&display_oled, linha, 0, y, false);
 
     // Envia tudo para o display físico
@@ -479,8 +591,9 @@ static void ciclar_telas(void) {
     tela_atual = (tela_atual + 1) % TOTAL_TELAS;
 
     if (tela_atual != TELA_PRINCIPAL) {
-        // Lê dados atuais do sensor para exibição
-        mpu6050_read_data(&dados_sensor_atuais);
+        // Lê dados atuais do sensor para exibição; gravando, o sensor é do
+        // timer de aquisição e os registros já atualizam os dados
+        if (!esta_gravando) mpu6050_read_data(&dados_sensor_atuais);
         // Agenda primeira atualização
         proxima_atualizacao_valores = get_absolute_time();
     }
@@ -531,49 +644,226 @@ static bool conectar_cartao_sd(void) {
 
     buscar_cartao_sd_por_nome(nome_drive)->mounted = true;
     cartao_sd_conectado = true;
-    printf("Cartão SD conectado com sucesso.\n");
+    printf("Cartão SD conectado com sucesso (SPI %u Hz).\n",
+        spi_get_baudrate(buscar_cartao_sd_por_nome(nome_drive)->spi->hw_inst));
+#if SD_SPI_BENCHMARK
+    // Tempos do SPI neste cartão (SD_SPI_BENCHMARK 1 em sd_card.h)
+    sd_spi_benchmark_t tempos;
+    sd_spi_benchmark(buscar_cartao_sd_por_nome(nome_drive), &tempos);
+    printf("SPI: byte %lu ns pela FIFO, %lu ns por DMA\n", tempos.xchg_ns, tempos.dma_byte_ns);
+    printf("SPI: bloco %lu us só DMA, %lu us com CMD17 (%lu us fora do bloco), %lu erros\n",
+        tempos.block_dma_ns / 1000, tempos.cmd17_ns / 1000,
+        (tempos.cmd17_ns - tempos.block_dma_ns) / 1000, tempos.read_errors);
+#endif
+
+#if !MODO_CAIXA_PRETA
+    // Conserta o arquivo de uma sessão interrompida por queda de energia
+    resultado = log_recuperar(&config_log_dados);
+    if (resultado != FR_OK) {
+        printf("Erro ao recuperar a última sessão: %s\n", FRESULT_str(resultado));
+    }
+#endif
+#if FLUXO_BRUTO
+    resultado = log_recuperar(&config_log_brutos);
+    if (resultado != FR_OK) {
+        printf("Erro ao recuperar o último fluxo bruto: %s\n", FRESULT_str(resultado));
+    }
+#endif
     return true;
 }
 
-// Desconecta o cartão SD de forma segura
-static void desconectar_cartao_sd(void) {
-    if (!cartao_sd_conectado) return;
+// Mostra no terminal USB as estatísticas do cartão SD e da escrita assíncrona
+static void imprimir_diagnostico_sd(void) {
+    sd_card_t *cartao = sd_get_by_num(0);
+    printf("SD: SPI %u Hz, %lu reducoes de clock por erro de CRC\n",
+        spi_get_baudrate(cartao->spi->hw_inst), cartao->baud_fallbacks);
+    printf("SD: AU de %lu KB, classe de velocidade %u\n",
+        cartao->au_sectors / 2, cartao->speed_class);
+#if SD_ASYNC_WRITE_ENABLED
+    sd_async_stats_t estatisticas;
+    sd_write_async_get_stats(cartao, &estatisticas);
+    printf("SD: %lu escritas, %lu erros, fila %lu (max %lu), espera max %lu us, ocupado max %lu us\n",
+        estatisticas.completed, estatisticas.errors,
+        estatisticas.queue_depth, estatisticas.max_queue_depth,
+        estatisticas.max_stall_us, estatisticas.max_busy_us);
+#endif
+
+    disk_cache_stats_t cache;
+    disk_cache_get_stats(&cache);
+    printf("Cache: %lu acertos, %lu faltas, %lu setores gravados em %lu escritas no cartao\n",
+        cache.read_hits, cache.read_misses, cache.writes, cache.device_writes);
+
+    // Disputa pelo volume entre os núcleos (FatFs reentrante)
+    ff_mutex_stats_t disputa;
+    ff_mutex_get_stats(0, &disputa);
+    printf("FatFs: %lu acessos, %lu esperas (max %lu us), %lu timeouts\n",
+        disputa.takes, disputa.contended, disputa.max_wait_us, disputa.timeouts);
+
+    estatisticas_memoria_t memoria;
+    memoria_obter_estatisticas(&memoria);
+    printf("Memoria: arena %lu/%u bytes, pool pico %lu/%u blocos, %lu falhas\n",
+        memoria.arena_usada, MEMORIA_ARENA_BYTES,
+        memoria.pool_pico, MEMORIA_POOL_BLOCOS, memoria.falhas);
+}
 
-    // Para a gravação se estiver ativa
-    if (esta_gravando) {
-        esta_gravando = false;
-        definir_cor_led(false, true, false); // LED verde = parado
+// Fecha o destino dos dados conforme o modo de gravação
+static void fechar_arquivos_de_dados(void) {
+#if MODO_CAIXA_PRETA
+    caixa_preta_fechar(&caixa_preta);
+#else
+    log_fechar(&log_dados);
+    if (log_dados.falhas_apagamento) {
+        printf("Log: %lu reservas sem apagamento\n", (unsigned long)log_dados.falhas_apagamento);
     }
-
-    const char *nome_drive = sd_get_by_num(0)->pcName;
-    f_unmount(nome_drive);
-    buscar_cartao_sd_por_nome(nome_drive)->mounted = false;
-    cartao_sd_conectado = false;
-
-    definir_cor_led(false, false, false); // LED apagado
-    alterar_status_display("SD OFF");
-    alterar_mensagem_display("");
-    printf("Cartão SD desconectado.\n");
+#endif
+#if FLUXO_BRUTO
+    fluxo_bruto_fechar(&fluxo_bruto);
+    if (leitor_bruto.perdidas) {
+        printf("Fluxo bruto: %lu leituras perdidas no anel\n", (unsigned long)leitor_bruto.perdidas);
+    }
+    if (fluxo_bruto.log.falhas_apagamento) {
+        printf("Fluxo bruto: %lu reservas sem apagamento\n",
+            (unsigned long)fluxo_bruto.log.falhas_apagamento);
+    }
+#endif
 }
 
 // FUNÇÕES DE GRAVAÇÃO DE DADOS
 
-// Cria o arquivo CSV com o cabeçalho das colunas
-static void criar_arquivo_csv_com_cabecalho(void) {
-    if (!cartao_sd_conectado) return;
+#if MODO_CAIXA_PRETA
+// Abre o arquivo circular da caixa-preta, continuando de onde parou
+static bool abrir_caixa_preta(void) {
+    if (!cartao_sd_conectado) return false;
+
+    FRESULT resultado = caixa_preta_abrir(&caixa_preta, "caixa_preta.bin",
+                                          BLOCOS_CAIXA_PRETA, TEMPO_ENTRE_LEITURAS_MS,
+                                          FORMATO_CAIXA_PRETA);
+    if (resultado != FR_OK) {
+        printf("Erro ao abrir caixa-preta: %s\n", FRESULT_str(resultado));
+        return false;
+    }
+    return true;
+}
+#else
+#define TEXTO(x) #x
+#define TEXTO_MACRO(x) TEXTO(x)
+
+// Cabeçalho dos CSVs: linhas "# chave=valor" que descrevem a sessão, para
+// que a análise não precise supor a taxa e as escalas
+// (plotar_graficos/esquema_registro.py lê), seguidas das colunas gravadas.
+// Todos os arquivos da sessão repetem o mesmo cabeçalho.
+static void montar_cabecalho_csv(void) {
+    int tamanho = snprintf(cabecalho_csv, sizeof(cabecalho_csv),
+        "# firmware=%s\n"
+        "# inicio_ms=%lu\n" // Desde o boot; o índice .idx conta a partir daqui
+        "# periodo_ms=%u\n"
+        "# periodo_aquisicao_ms=" TEXTO_MACRO(PERIODO_AQUISICAO_MS) "\n"
+        "# decimacao=" TEXTO_MACRO(DECIMACAO) "\n"
+        "# divisor_acel=" TEXTO_MACRO(DIVISOR_ACEL) "\n"
+        "# divisor_giro=" TEXTO_MACRO(DIVISOR_GIRO) "\n"
+        "# divisor_temp=" TEXTO_MACRO(DIVISOR_TEMP) "\n"
+        "# acel_faixa_g=" TEXTO_MACRO(MPU6050_FAIXA_ACEL_G) "\n"
+        "# acel_lsb_por_g=" TEXTO_MACRO(MPU6050_LSB_POR_G) "\n"
+        "# gravidade_ms2=" TEXTO_MACRO(MPU6050_GRAVIDADE_MS2) "\n"
+        "# giro_faixa_dps=" TEXTO_MACRO(MPU6050_FAIXA_GIRO_DPS) "\n"
+        "# giro_lsb_por_dps=" TEXTO_MACRO(MPU6050_LSB_POR_DPS) "\n"
+        "# temp_lsb_por_c=" TEXTO_MACRO(MPU6050_TEMP_LSB_POR_C) "\n"
+        "# temp_offset_c=" TEXTO_MACRO(MPU6050_TEMP_OFFSET_C) "\n"
+        "# temp_calibracao_c=" TEXTO_MACRO(MPU6050_TEMP_CALIBRACAO_C) "\n"
+        "# largura_fixa=" TEXTO_MACRO(CSV_LARGURA_FIXA) "\n",
+        VERSAO_FIRMWARE, (unsigned long)to_ms_since_boot(get_absolute_time()),
+        (unsigned)TEMPO_ENTRE_LEITURAS_MS);
+    if (tamanho < 0 || tamanho >= (int)sizeof(cabecalho_csv)) tamanho = 0; // Não coube: só as colunas
+    registro_cabecalho_csv(cabecalho_csv + tamanho, sizeof(cabecalho_csv) - tamanho, CANAIS_GRAVADOS);
+}
+
+// Abre os arquivos CSV da sessão, cada um começando com o cabeçalho
+static bool abrir_arquivo_csv_com_cabecalho(void) {
+    if (!cartao_sd_conectado) return false;
 
-    FIL arquivo;
-    if (f_open(&arquivo, "dados_MPU3.csv", FA_WRITE | FA_CREATE_NEW) == FR_OK) {
-        const char *cabecalho = 
-            "Amostra,Acel_X,Acel_Y,Acel_Z,Giro_X,Giro_Y,Giro_Z,Temperatura\n";
-        f_write(&arquivo, cabecalho, strlen(cabecalho), NULL);
-        f_close(&arquivo);
-        printf("Arquivo CSV criado com sucesso.\n");
+    montar_cabecalho_csv();
+    FRESULT resultado = log_abrir(&log_dados, &config_log_dados);
+    if (resultado != FR_OK) {
+        printf("Erro ao criar arquivo CSV: %s\n", FRESULT_str(resultado));
+        return false;
+    }
+#if CSV_LARGURA_FIXA
+    csv_fixo_iniciar(&linha_fixa);
+#endif
+    printf("Arquivo CSV criado com sucesso.\n");
+    return true;
+}
+#endif
+
+#if FLUXO_BRUTO
+// Abre os arquivos do fluxo bruto da sessão
+static bool abrir_fluxo_bruto(void) {
+    FRESULT resultado = fluxo_bruto_abrir(&fluxo_bruto, &config_log_brutos,
+                                          PERIODO_AQUISICAO_MS, &esquema_canais,
+                                          BLOCOS_POR_SINCRONIZACAO);
+    if (resultado != FR_OK) {
+        printf("Erro ao criar arquivo bruto: %s\n", FRESULT_str(resultado));
+        return false;
+    }
+    return true;
+}
+#endif
+
+// Abre o destino dos dados conforme o modo de gravação
+static bool abrir_arquivos_de_dados(void) {
+    // Os dois fluxos começam na próxima leitura, com a média vazia, e a
+    // primeira leitura da sessão lê todos os canais
+    leituras_da_sessao = 0;
+    anel_leitor_iniciar(&anel_aquisicao, &leitor_registros);
+    decimador_iniciar(&decimador, DECIMACAO);
+#if FLUXO_BRUTO
+    anel_leitor_iniciar(&anel_aquisicao, &leitor_bruto);
+#endif
+
+#if MODO_CAIXA_PRETA
+    bool aberto = abrir_caixa_preta();
+#else
+    bool aberto = abrir_arquivo_csv_com_cabecalho();
+#endif
+#if FLUXO_BRUTO
+    if (aberto && !abrir_fluxo_bruto()) {
+        fechar_arquivos_de_dados();
+        aberto = false;
     }
+#endif
+    return aberto;
 }
 
-// Lê dados do sensor MPU6050 e salva no cartão SD
-static void gravar_dados_do_sensor(void) {
+// Entre leituras: deixa os próximos arquivos prontos, assim a troca de
+// arquivo não atrasa a aquisição
+static void preparar_proximos_arquivos(void) {
+#if !MODO_CAIXA_PRETA
+    log_preparar_proximo(&log_dados);
+#endif
+#if FLUXO_BRUTO
+    log_preparar_proximo(&fluxo_bruto.log);
+#endif
+}
+
+// Lê do sensor os canais da vez e publica a leitura no anel de aquisição
+static void adquirir_amostra(void) {
+    uint8_t canais = esquema_canais_da_vez(&esquema_canais, leituras_da_sessao++);
+    mpu6050_read_raw_canais(&ultima_leitura, canais);
+    anel_publicar(&anel_aquisicao, &ultima_leitura, canais);
+}
+
+// Timer de aquisição (roda na interrupção do alarme). Com o período negativo
+// o pico-sdk agenda cada chamada a partir do horário previsto da anterior,
+// então as leituras não atrasam com o cartão, o display ou o loop: só o
+// consumo do anel é feito no loop principal.
+static bool tratar_timer_aquisicao(repeating_timer_t *timer) {
+    (void)timer;
+    adquirir_amostra();
+    return true;
+}
+
+// Salva no cartão SD um registro (a média de DECIMACAO leituras)
+static void gravar_registro(const mpu6050_raw_t *dados_brutos) {
     if (!cartao_sd_conectado) {
         alterar_status_display("ERRO: SEM SD");
         piscar_led_erro_critico();
@@ -582,28 +872,40 @@ static void gravar_dados_do_sensor(void) {
     // LED azul indica que está gravando dados
     definir_cor_led(false, false, true);
 
-    // Abre o arquivo CSV para adicionar nova linha
-    FIL arquivo;
-    if (f_open(&arquivo, "dados_MPU3.csv", FA_WRITE | FA_OPEN_APPEND) != FR_OK) {
+    // Converte o registro para unidades físicas; é o que as telas mostram
+    mpu6050_convert(dados_brutos, &dados_sensor_atuais);
+
+#if MODO_CAIXA_PRETA
+    // Acrescenta a amostra bruta ao anel
+    if (caixa_preta_gravar(&caixa_preta, ++contador_amostras, dados_brutos) != FR_OK) {
         alterar_status_display("ERRO ARQUIVO");
         piscar_led_erro_critico();
     }
-
-    // Lê os dados atuais do sensor MPU6050
-    mpu6050_read_data(&dados_sensor_atuais);
-
-    // Formata os dados em uma linha CSV
+#else
+#if CSV_LARGURA_FIXA
+    // Só os dígitos do modelo da linha são reescritos
+    const char *linha_dados = csv_fixo_preencher(&linha_fixa, ++contador_amostras,
+                                                 &dados_sensor_atuais);
+    UINT tamanho_linha = CSV_FIXO_TAMANHO_LINHA;
+#else
+    // Formata os canais gravados em uma linha CSV
     char linha_dados[256];
-    snprintf(linha_dados, sizeof(linha_dados),
-        "%lu,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.2f\n",
-        ++contador_amostras,
-        dados_sensor_atuais.accel_x, dados_sensor_atuais.accel_y, dados_sensor_atuais.accel_z,
-        dados_sensor_atuais.gyro_x,  dados_sensor_atuais.gyro_y,  dados_sensor_atuais.gyro_z,
-        dados_sensor_atuais.temp_c);
-
-    // Grava a linha no arquivo e fecha
-    f_write(&arquivo, linha_dados, strlen(linha_dados), NULL);
-    f_close(&arquivo);
+    UINT tamanho_linha = registro_formatar_csv(linha_dados, sizeof(linha_dados),
+                                               ++contador_amostras, &dados_sensor_atuais,
+                                               CANAIS_GRAVADOS);
+#endif
+
+    // Grava a linha no arquivo (que continua aberto); de tempos em tempos
+    // leva os dados ao cartão e registra o checkpoint
+    FRESULT resultado = log_escrever(&log_dados, linha_dados, tamanho_linha);
+    if (resultado == FR_OK && contador_amostras % AMOSTRAS_POR_CHECKPOINT == 0) {
+        resultado = log_checkpoint(&log_dados, contador_amostras);
+    }
+    if (resultado != FR_OK) {
+        alterar_status_display("ERRO ARQUIVO");
+        piscar_led_erro_critico();
+    }
+#endif
 
     // LED vermelho indica sistema ativo
     definir_cor_led(true, false, false);
@@ -613,6 +915,43 @@ static void gravar_dados_do_sensor(void) {
     alterar_mensagem_display("Dados salvos");
 }
 
+// Consome as leituras novas do anel de aquisição: cada fluxo tem o seu
+// leitor, o seu buffer e o seu ritmo de sincronização, e nenhum deles lê o
+// sensor de novo. Retorna false se não havia leitura nova.
+static bool gravar_dados_do_sensor(void) {
+    bool gravou = false;
+    amostra_anel_t amostra;
+#if FLUXO_BRUTO
+    while (anel_ler(&anel_aquisicao, &leitor_bruto, &amostra)) {
+        if (fluxo_bruto_gravar(&fluxo_bruto, &amostra) != FR_OK) {
+            alterar_status_display("ERRO ARQUIVO");
+            piscar_led_erro_critico();
+        }
+        gravou = true;
+    }
+#endif
+    mpu6050_raw_t media;
+    while (anel_ler(&anel_aquisicao, &leitor_registros, &amostra)) {
+        if (decimador_acrescentar(&decimador, &amostra.raw, amostra.canais, &media)) {
+            gravar_registro(&media);
+        }
+        gravou = true;
+    }
+    return gravou;
+}
+
+// Começa a ler o sensor a cada PERIODO_AQUISICAO_MS, a primeira vez agora
+static void iniciar_aquisicao(void) {
+    adquirir_amostra();
+    add_repeating_timer_ms(-PERIODO_AQUISICAO_MS, tratar_timer_aquisicao, NULL, &timer_aquisicao);
+}
+
+// Para o timer antes de fechar os arquivos; o que já está no anel é gravado
+static void parar_aquisicao(void) {
+    cancel_repeating_timer(&timer_aquisicao);
+    gravar_dados_do_sensor();
+}
+
 // FUNÇÕES DE CONTROLE DA GRAVAÇÃO
 
 // Inicia o processo de coleta e gravação de dados
@@ -623,32 +962,72 @@ static void iniciar_gravacao_dados(void) {
     }
     if (esta_gravando) return; // Já está gravando
 
+    // Cada sessão de gravação começa um arquivo novo (ou continua o anel)
+    if (!abrir_arquivos_de_dados()) {
+        alterar_status_display("ERRO ARQUIVO");
+        return;
+    }
+
     esta_gravando = true;
     definir_cor_led(true, false, false); // LED vermelho = gravando
     alterar_status_display("GRAVANDO");
     alterar_mensagem_display("");
-    proxima_medicao = get_absolute_time();
+    iniciar_aquisicao();
 
     // Emite beep curto ao iniciar a coleta (não-bloqueante)
     iniciar_beep_curto();
 }
 
+// Para o sensor, grava o que já foi lido e fecha os arquivos
+static void encerrar_gravacao(void) {
+    parar_aquisicao();
+    esta_gravando = false;
+    fechar_arquivos_de_dados();
+    definir_cor_led(false, true, false); // LED verde = parado
+}
+
 // Para o processo de coleta e gravação de dados
 static void parar_gravacao_dados(void) {
     if (!esta_gravando) return; // Já está parado
 
-    esta_gravando = false;
-    definir_cor_led(false, true, false); // LED verde = parado
+    encerrar_gravacao();
     alterar_status_display("PAUSADO");
     alterar_mensagem_display("");
+    imprimir_diagnostico_sd();
 
     // Emite dois beeps curtos ao parar a coleta (não-bloqueante)
     iniciar_dois_beeps();
 }
 
+// Desconecta o cartão SD de forma segura
+static void desconectar_cartao_sd(void) {
+    if (!cartao_sd_conectado) return;
+
+    // Para a gravação se estiver ativa, gravando o que ainda está no anel
+    if (esta_gravando) encerrar_gravacao();
+
+    const char *nome_drive = sd_get_by_num(0)->pcName;
+    f_unmount(nome_drive);
+    buscar_cartao_sd_por_nome(nome_drive)->mounted = false;
+    cartao_sd_conectado = false;
+    imprimir_diagnostico_sd();
+
+    definir_cor_led(false, false, false); // LED apagado
+    alterar_status_display("SD OFF");
+    alterar_mensagem_display("");
+    printf("Cartão SD desconectado.\n");
+}
+
 // FUNÇÕES DOS BOTÕES DE CONTROLE
 
-// Função chamada quando um botão é pressionado
+// Cliques recebidos pela interrupção e ainda não tratados pelo loop principal
+static volatile bool clique_cartao_sd = false;
+static volatile bool clique_gravacao = false;
+static volatile bool clique_valores = false;
+
+// Função chamada (na interrupção) quando um botão é pressionado. Só anota o
+// clique: montar o cartão, abrir e fechar arquivos e desenhar as telas
+// levam tempo e usam o FatFs e o I2C, então ficam para o loop principal.
 static void processar_clique_botao(uint pino_gpio, uint32_t eventos) {
     // Implementa debounce - evita múltiplos cliques acidentais
     static uint64_t ultimo_clique = 0;
@@ -656,22 +1035,38 @@ static void processar_clique_botao(uint pino_gpio, uint32_t eventos) {
     if (agora - ultimo_clique < TEMPO_DEBOUNCE_US) return;
     ultimo_clique = agora;
 
-    // Processa ação baseada no botão pressionado
     if (pino_gpio == BOTAO_CARTAO_SD) {
+        clique_cartao_sd = true;
+    } else if (pino_gpio == BOTAO_GRAVACAO) {
+        clique_gravacao = true;
+    } else if (pino_gpio == BOTAO_VALORES) {
+        clique_valores = true;
+    }
+}
+
+// Executa, no loop principal, a ação dos botões clicados
+static void tratar_cliques_botoes(void) {
+    // Processa ação baseada no botão pressionado
+    if (clique_cartao_sd) {
+        clique_cartao_sd = false;
         // Alterna entre conectar/desconectar cartão SD
         if (cartao_sd_conectado) {
             desconectar_cartao_sd();
         } else {
             conectar_cartao_sd();
         }
-    } else if (pino_gpio == BOTAO_GRAVACAO) {
+    }
+    if (clique_gravacao) {
+        clique_gravacao = false;
         // Alterna entre iniciar/parar gravação
         if (esta_gravando) {
             parar_gravacao_dados();
         } else {
             iniciar_gravacao_dados();
         }
-    } else if (pino_gpio == BOTAO_VALORES) {
+    }
+    if (clique_valores) {
+        clique_valores = false;
         // Cicla entre as telas: principal -> valores -> gráfico -> principal
         ciclar_telas();
     }
@@ -722,15 +1117,13 @@ static bool inicializar_sistema_completo(void) {
     gpio_pull_up(I2C_SENSOR_SDA);
     gpio_pull_up(I2C_SENSOR_SCL);
 
-    // Inicializa o sensor MPU6050
+    // Inicializa o sensor MPU6050 e o anel que recebe as suas leituras
     mpu6050_init(I2C_SENSOR_PORTA);
+    anel_iniciar(&anel_aquisicao);
 
     // Configura botões de controle
     configurar_botoes_controle();
 
-    // Cria arquivo CSV inicial
-    criar_arquivo_csv_com_cabecalho();
-
     // Sistema pronto para uso
     definir_cor_led(false, true, false); // LED verde = pronto
     alterar_status_display("PRONTO");
@@ -767,23 +1160,24 @@ int main(void) {
         // ATUALIZA O BUZZER PRIMEIRO (não-bloqueante)
         atualizar_buzzer();
 
+        // Ações dos botões clicados desde a última volta
+        tratar_cliques_botoes();
+
         // Se está na tela de valores ou gráfico, atualiza os dados periodicamente
         if ((tela_atual == TELA_VALORES || tela_atual == TELA_GRAFICO) &&
             time_reached(proxima_atualizacao_valores)) {
-            // Lê novos dados do sensor
-            mpu6050_read_data(&dados_sensor_atuais);
+            // Lê novos dados do sensor; gravando, os registros já os atualizam
+            if (!esta_gravando) mpu6050_read_data(&dados_sensor_atuais);
             // Atualiza a tela com os novos valores
             atualizar_tela();
             // Agenda próxima atualização
             proxima_atualizacao_valores = make_timeout_time_ms(TEMPO_ATUALIZACAO_VALORES_MS);
         }
 
-        // Se está gravando E cartão SD conectado E chegou a hora da próxima medição
-        if (esta_gravando && cartao_sd_conectado && time_reached(proxima_medicao)) {
-            // Agenda próxima medição
-            proxima_medicao = make_timeout_time_ms(TEMPO_ENTRE_LEITURAS_MS);
-            // Grava dados do sensor
-            gravar_dados_do_sensor();
+        // Grava o que o timer de aquisição pôs no anel; sem nada novo,
+        // prepara os próximos arquivos
+        if (esta_gravando && cartao_sd_conectado && !gravar_dados_do_sensor()) {
+            preparar_proximos_arquivos();
         }
 
         // Pequena pausa para não sobrecarregar o processador
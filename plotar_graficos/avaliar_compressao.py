@@ -0,0 +1,216 @@
+import csv
+import glob
+import os
+import struct
+import sys
+import time
+
+from esquema_registro import escalas, ler_cabecalho
+from reconstruir_caixa_preta import (REGISTRO, LIMITES, REGISTROS_COLUNAS, decodificar_bruto,
+                                     decodificar_delta, decodificar_lz, decodificar_colunas)
+
+# Compara os formatos de bloco da caixa-preta usando os CSVs gravados como
+# amostra: quantas amostras cabem em um bloco de 512 bytes e a velocidade de
+# codificação/decodificação aqui no PC. Os CSVs são convertidos de volta para
+# os valores brutos do sensor, que é o que o firmware compacta.
+#
+# Uso: python avaliar_compressao.py [arquivos.csv...]   (padrão: *.csv desta pasta)
+
+BYTES_POR_BLOCO = 490  # CAIXA_PRETA_DADOS em lib/Logger_Bibliotecas/caixa_preta.h
+LZ_ENTRADA_MAXIMA = 2048  # lib/Logger_Bibliotecas/compressor_lz.h
+LZ_BITS_TABELA = 9
+
+
+def ler_csv_como_bruto(caminho):
+    """Desfaz as conversões de lib/mpu6050.c, voltando aos valores em LSB,
+    com as escalas do cabeçalho do arquivo."""
+    def lsb(valor):
+        return max(-32768, min(32767, round(valor)))
+
+    amostras = []
+    with open(caminho, 'rb') as arquivo:
+        metadados = ler_cabecalho(arquivo)[0]
+    e = escalas(metadados)
+    with open(caminho, newline='') as arquivo:
+        linhas = (linha for linha in arquivo if not linha.startswith('#'))
+        for linha in csv.DictReader(linhas):
+            ax, ay, az = (float(linha[c]) / e['gravidade_ms2'] * e['acel_lsb_por_g']
+                          for c in ('Acel_X', 'Acel_Y', 'Acel_Z'))
+            gx, gy, gz = (float(linha[c]) * e['giro_lsb_por_dps']
+                          for c in ('Giro_X', 'Giro_Y', 'Giro_Z'))
+            temp = ((float(linha['Temperatura']) - e['temp_offset_c'] - e['temp_calibracao_c'])
+                    * e['temp_lsb_por_c'])
+            amostras.append(tuple(lsb(v) for v in (ax, ay, az, temp, gx, gy, gz)))
+    return amostras
+
+
+# --- CODIFICADORES (mesmas regras do firmware) ---
+
+def codificar_bruto(amostras):
+    """Um bloco por vez; retorna (carga, registros) de cada bloco."""
+    por_bloco = BYTES_POR_BLOCO // REGISTRO.size
+    return [(b''.join(REGISTRO.pack(*a) for a in amostras[i:i + por_bloco]),
+             len(amostras[i:i + por_bloco]))
+            for i in range(0, len(amostras), por_bloco)]
+
+
+def varint(valor):
+    saida = bytearray()
+    while valor >= 0x80:
+        saida.append((valor & 0x7F) | 0x80)
+        valor >>= 7
+    saida.append(valor)
+    return bytes(saida)
+
+
+def codificar_delta(amostras):
+    """Porte de lib/Logger_Bibliotecas/codificador_delta.c."""
+    blocos = []
+    carga, registros, anterior = bytearray(), 0, None
+    for amostra in amostras:
+        if registros == 0:
+            codigo = REGISTRO.pack(*amostra)
+        else:
+            codigo = b''
+            for atual, base in zip(amostra, anterior):
+                diferenca = (atual - base + 0x8000) % 0x10000 - 0x8000
+                codigo += varint(((diferenca << 1) ^ (diferenca >> 15)) & 0xFFFF)
+        if len(carga) + len(codigo) > BYTES_POR_BLOCO:
+            blocos.append((bytes(carga), registros))
+            carga, registros = bytearray(), 0
+            codigo = REGISTRO.pack(*amostra)  # Bloco novo começa com quadro-chave
+        carga += codigo
+        registros += 1
+        anterior = amostra
+    if registros:
+        blocos.append((bytes(carga), registros))
+    return blocos
+
+
+def lz_extra(resto):
+    saida = bytearray()
+    while resto >= 255:
+        saida.append(255)
+        resto -= 255
+    saida.append(resto)
+    return saida
+
+
+def lz_sequencia(literais, distancia, comprimento):
+    extra = comprimento - 4 if comprimento else 0
+    saida = bytearray([(min(len(literais), 15) << 4) | min(extra, 15)])
+    if len(literais) >= 15:
+        saida += lz_extra(len(literais) - 15)
+    saida += literais
+    if comprimento:
+        saida += bytes([distancia & 0xFF, distancia >> 8])
+        if extra >= 15:
+            saida += lz_extra(extra - 15)
+    return saida
+
+
+def lz_compactar(entrada):
+    """Porte de lz_compactar() em lib/Logger_Bibliotecas/compressor_lz.c."""
+    tabela = {}
+    saida = bytearray()
+    posicao = inicio_literais = 0
+    while posicao + 4 <= len(entrada):
+        valor = int.from_bytes(entrada[posicao:posicao + 4], 'little')
+        h = ((valor * 2654435761) & 0xFFFFFFFF) >> (32 - LZ_BITS_TABELA)
+        candidata = tabela.get(h)
+        tabela[h] = posicao
+        if candidata is None or entrada[candidata:candidata + 4] != entrada[posicao:posicao + 4]:
+            posicao += 1
+            continue
+        comprimento = 4
+        while (posicao + comprimento < len(entrada) and
+               entrada[candidata + comprimento] == entrada[posicao + comprimento]):
+            comprimento += 1
+        saida += lz_sequencia(entrada[inicio_literais:posicao], posicao - candidata, comprimento)
+        posicao += comprimento
+        inicio_literais = posicao
+    return bytes(saida + lz_sequencia(entrada[inicio_literais:], 0, 0))
+
+
+def em_colunas(amostras):
+    """Valores canal por canal, como transpor_lz() no firmware."""
+    return b''.join(struct.pack(f'<{len(amostras)}h', *canal) for canal in zip(*amostras))
+
+
+def codificar_lz(amostras):
+    """Como o firmware: recomprime o bloco a cada amostra até não caber mais."""
+    blocos = []
+    entrada, comprimido = [], b''
+    for amostra in amostras:
+        tentativa = entrada + [amostra]
+        resultado = (lz_compactar(em_colunas(tentativa))
+                     if len(tentativa) * REGISTRO.size <= LZ_ENTRADA_MAXIMA else None)
+        if resultado is None or len(resultado) > BYTES_POR_BLOCO:
+            blocos.append((comprimido, len(entrada)))
+            tentativa = [amostra]
+            resultado = lz_compactar(em_colunas(tentativa))
+        entrada, comprimido = tentativa, resultado
+    if entrada:
+        blocos.append((comprimido, len(entrada)))
+    return blocos
+
+
+def codificar_colunas(amostras):
+    """Porte de acrescentar_colunas() em lib/Logger_Bibliotecas/caixa_preta.c:
+    limites e colunas de tamanho fixo, então o bloco ocupa sempre o mesmo."""
+    blocos = []
+    for i in range(0, len(amostras), REGISTROS_COLUNAS):
+        grupo = amostras[i:i + REGISTROS_COLUNAS]
+        canais = list(zip(*grupo))
+        carga = LIMITES.pack(*[min(c) for c in canais], *[max(c) for c in canais])
+        for canal in canais:
+            carga += struct.pack(f'<{REGISTROS_COLUNAS}h',
+                                 *canal, *[0] * (REGISTROS_COLUNAS - len(canal)))
+        blocos.append((carga, len(grupo)))
+    return blocos
+
+
+FORMATOS = [
+    ('bruto', codificar_bruto, decodificar_bruto),
+    ('delta', codificar_delta, decodificar_delta),
+    ('lz', codificar_lz, decodificar_lz),
+    ('colunas', codificar_colunas, decodificar_colunas),
+]
+
+
+def avaliar(nome_arquivo, amostras):
+    print(f"\n{nome_arquivo}: {len(amostras)} amostras")
+    bytes_brutos = len(amostras) * REGISTRO.size
+    for nome, codificar, decodificar in FORMATOS:
+        inicio = time.perf_counter()
+        blocos = codificar(amostras)
+        tempo_codificar = time.perf_counter() - inicio
+
+        inicio = time.perf_counter()
+        decodificadas = [a for carga, registros in blocos for a in decodificar(carga, registros)]
+        tempo_decodificar = time.perf_counter() - inicio
+
+        if decodificadas != amostras:
+            print(f"  {nome:8s} ERRO: a decodificação não reproduz as amostras")
+            continue
+        bytes_usados = sum(len(carga) for carga, _ in blocos)
+        print(f"  {nome:8s} {bytes_brutos / bytes_usados:5.2f}x   "
+              f"{len(amostras) / len(blocos):6.1f} amostras/bloco   "
+              f"{len(amostras) / tempo_codificar / 1000:7.1f} k amostras/s codificando   "
+              f"{len(amostras) / tempo_decodificar / 1000:7.1f} k amostras/s decodificando")
+
+
+def main():
+    pasta = os.path.dirname(os.path.abspath(__file__))
+    arquivos = sys.argv[1:] or sorted(glob.glob(os.path.join(pasta, '*.csv')))
+    if not arquivos:
+        print("Nenhum arquivo CSV encontrado.")
+        sys.exit(1)
+    for caminho in arquivos:
+        amostras = ler_csv_como_bruto(caminho)
+        if amostras:
+            avaliar(os.path.basename(caminho), amostras)
+
+
+if __name__ == '__main__':
+    main()
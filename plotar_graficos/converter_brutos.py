@@ -0,0 +1,90 @@
+import struct
+import sys
+
+from esquema_registro import ESCALAS_PADRAO, colunas, desempacotar, escrever_cabecalho, formatar
+from reconstruir_caixa_preta import converter
+
+# Converte um arquivo do fluxo bruto (brutos_MPU_NNNN.bin, todas as leituras
+# do sensor) para um CSV no mesmo formato dos arquivos dados_MPU_*.csv, que
+# plot.py lê. A coluna Amostra traz o número da leitura. Só os canais
+# gravados viram colunas; um canal lido a cada N leituras repete o último
+# valor nas leituras entre elas (nan antes da primeira).
+#
+# Uso: python converter_brutos.py brutos_MPU_0001.bin [saida.csv]
+
+# --- FORMATO DO BLOCO (lib/Logger_Bibliotecas/fluxo_bruto.h) ---
+TAMANHO_BLOCO = 512
+# primeira_amostra, registros, periodo_ms, tamanho, canais, reservado, divisores[3]
+# Os valores de cada registro seguem a tabela de esquema_registro.h
+CABECALHO = struct.Struct('<IHHHBB3H')
+DADOS = TAMANHO_BLOCO - CABECALHO.size
+# Campos de mpu6050_raw_t (lib/mpu6050.h), na ordem que converter() recebe
+CAMPOS_BRUTOS = ('accel_x', 'accel_y', 'accel_z', 'temp', 'gyro_x', 'gyro_y', 'gyro_z')
+# Campos de mpu6050_data_t, na ordem que converter() devolve
+CAMPOS_CONVERTIDOS = ('accel_x', 'accel_y', 'accel_z', 'gyro_x', 'gyro_y', 'gyro_z', 'temp_c')
+# ---------------------
+
+
+def ler_blocos(caminho):
+    """Lê as leituras dos blocos gravados; o espaço reservado que não chegou
+    a ser usado (tamanho 0 ou inválido) é ignorado. Retorna as leituras com
+    os 7 canais (valores repetidos entre leituras de um grupo), o período e
+    os grupos gravados."""
+    leituras = []
+    periodo = canais_gravados = None
+    atual = dict.fromkeys(CAMPOS_BRUTOS)
+    with open(caminho, 'rb') as arquivo:
+        while True:
+            dados = arquivo.read(TAMANHO_BLOCO)
+            if len(dados) < TAMANHO_BLOCO:
+                break
+            (primeira, registros, periodo_bloco, tamanho,
+             canais, _, *_divisores) = CABECALHO.unpack_from(dados)
+            if tamanho == 0 or tamanho > DADOS:
+                continue
+            periodo, canais_gravados = periodo_bloco, canais
+            posicao = CABECALHO.size
+            for i in range(registros):
+                lidos = dados[posicao]
+                valores, posicao = desempacotar(dados, posicao + 1, lidos)
+                atual.update(valores)
+                leituras.append((primeira + i, [atual[campo] for campo in CAMPOS_BRUTOS]))
+    return leituras, periodo, canais_gravados
+
+
+def main():
+    if len(sys.argv) < 2:
+        print("Uso: python converter_brutos.py brutos_MPU_0001.bin [saida.csv]")
+        sys.exit(1)
+    entrada = sys.argv[1]
+    saida = sys.argv[2] if len(sys.argv) > 2 else 'brutos.csv'
+
+    try:
+        leituras, periodo, canais = ler_blocos(entrada)
+    except FileNotFoundError:
+        print(f"ERRO: Arquivo '{entrada}' não encontrado.")
+        sys.exit(1)
+
+    canais = canais or 0
+    perdidas = 0
+    with open(saida, 'w') as arquivo:
+        if leituras:
+            escrever_cabecalho(arquivo, {'periodo_ms': periodo, **ESCALAS_PADRAO})
+        arquivo.write(",".join(colunas(canais)) + "\n")
+        anterior = None
+        for numero, bruto in leituras:
+            if anterior is not None and numero > anterior + 1:
+                perdidas += numero - anterior - 1
+            anterior = numero
+            valores = converter([float('nan') if v is None else v for v in bruto])
+            arquivo.write(formatar(numero, dict(zip(CAMPOS_CONVERTIDOS, valores)), canais) + "\n")
+
+    if leituras:
+        print(f"{len(leituras)} leituras a cada {periodo} ms gravadas em '{saida}' "
+              f"({perdidas} perdidas no anel de aquisição).")
+    else:
+        print("Nenhum bloco gravado encontrado.")
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,118 @@
+import os
+import re
+import struct
+
+# Lê a tabela ESQUEMA_REGISTRO de lib/Logger_Bibliotecas/esquema_registro.h,
+# a mesma que gera o cabeçalho e as linhas do CSV e o empacotamento do fluxo
+# bruto no firmware, para que os scripts não repitam a lista de canais. Lê
+# também o cabeçalho da sessão ("# chave=valor") que abre cada CSV.
+#
+# Uso: from esquema_registro import CAMPOS, colunas, ...
+
+PASTA_LIB = os.path.join(os.path.dirname(os.path.abspath(__file__)), '..', 'lib')
+ARQUIVO_ESQUEMA = os.path.join(PASTA_LIB, 'Logger_Bibliotecas', 'esquema_registro.h')
+ARQUIVO_MPU6050 = os.path.join(PASTA_LIB, 'mpu6050.h')
+
+# Bits MPU6050_CANAL_* (lib/mpu6050.h)
+GRUPOS = {
+    'MPU6050_CANAL_ACEL': 0x01,
+    'MPU6050_CANAL_TEMP': 0x02,
+    'MPU6050_CANAL_GIRO': 0x04,
+}
+TODOS_CANAIS = 0x07
+LARGURA_AMOSTRA_FIXA = 10  # CSV_FIXO_LARGURA_AMOSTRA em csv_largura_fixa.h
+
+LINHA = re.compile(r'X\((\w+),\s*(\w+),\s*(\w+),\s*(\w+),\s*(\d+),\s*(\d+)\)')
+# Chaves das escalas no cabeçalho da sessão e a constante de mpu6050.h de cada uma
+CONSTANTES_ESCALAS = {
+    'acel_lsb_por_g': 'MPU6050_LSB_POR_G',
+    'gravidade_ms2': 'MPU6050_GRAVIDADE_MS2',
+    'giro_lsb_por_dps': 'MPU6050_LSB_POR_DPS',
+    'temp_lsb_por_c': 'MPU6050_TEMP_LSB_POR_C',
+    'temp_offset_c': 'MPU6050_TEMP_OFFSET_C',
+    'temp_calibracao_c': 'MPU6050_TEMP_CALIBRACAO_C',
+}
+
+
+def ler_esquema(caminho=ARQUIVO_ESQUEMA):
+    """Linhas da tabela, em ordem: dicionários com coluna, convertido, bruto,
+    grupo (bit), casas e largura."""
+    with open(caminho, encoding='utf-8') as arquivo:
+        texto = arquivo.read()
+    campos = []
+    for coluna, convertido, bruto, grupo, casas, largura in LINHA.findall(texto):
+        campos.append({'coluna': coluna, 'convertido': convertido, 'bruto': bruto,
+                       'grupo': GRUPOS[grupo], 'casas': int(casas), 'largura': int(largura)})
+    return campos
+
+
+def ler_escalas(caminho=ARQUIVO_MPU6050):
+    """Escalas da conversão do firmware, pelas constantes de lib/mpu6050.h."""
+    with open(caminho, encoding='utf-8') as arquivo:
+        constantes = dict(re.findall(r'#define (MPU6050_\w+)\s+(-?[\d.]+)', arquivo.read()))
+    return {chave: float(constantes[nome]) for chave, nome in CONSTANTES_ESCALAS.items()}
+
+
+CAMPOS = ler_esquema()
+ESCALAS_PADRAO = ler_escalas()
+
+
+def campos_gravados(canais):
+    """Linhas da tabela cujos grupos estão na máscara."""
+    return [campo for campo in CAMPOS if canais & campo['grupo']]
+
+
+def colunas(canais=TODOS_CANAIS):
+    """Colunas do CSV, como em registro_cabecalho_csv()."""
+    return ['Amostra'] + [campo['coluna'] for campo in campos_gravados(canais)]
+
+
+def formatar(numero, valores, canais=TODOS_CANAIS):
+    """Linha do CSV (sem '\\n') com os valores convertidos, dados por nome do
+    campo em mpu6050_data_t, como em registro_formatar_csv()."""
+    return ",".join([str(numero)] + [f"{valores[campo['convertido']]:.{campo['casas']}f}"
+                                     for campo in campos_gravados(canais)])
+
+
+def desempacotar(dados, posicao, canais):
+    """Valores brutos de um registro de registro_empacotar(), por nome do campo
+    em mpu6050_raw_t, e a posição logo depois dele."""
+    gravados = campos_gravados(canais)
+    valores = struct.unpack_from(f'<{len(gravados)}h', dados, posicao)
+    return ({campo['bruto']: valor for campo, valor in zip(gravados, valores)},
+            posicao + 2 * len(gravados))
+
+
+def ler_cabecalho(arquivo):
+    """Lê o cabeçalho de um CSV, com o arquivo aberto em modo binário no
+    início: as linhas '# chave=valor' que descrevem a sessão (montar_cabecalho_csv()
+    no main.c; arquivos antigos não têm) e a linha com os nomes das colunas.
+    Retorna os metadados (valores em texto), as colunas e o cabeçalho inteiro,
+    em bytes, para quem precisa da posição da primeira amostra."""
+    metadados = {}
+    texto = b''
+    while True:
+        linha = arquivo.readline()
+        texto += linha
+        if not linha.startswith(b'#'):
+            break
+        chave, _, valor = linha[1:].decode().partition('=')
+        metadados[chave.strip()] = valor.strip()
+    return metadados, linha.decode().strip().split(','), texto
+
+
+def escalas(metadados):
+    """Escalas com que o arquivo foi gravado, as do firmware atual quando o
+    cabeçalho não traz (arquivos antigos)."""
+    return {chave: float(metadados.get(chave, padrao)) for chave, padrao in ESCALAS_PADRAO.items()}
+
+
+def escrever_cabecalho(arquivo, metadados):
+    """Escreve as linhas '# chave=valor' de um CSV gerado no computador."""
+    for chave, valor in metadados.items():
+        arquivo.write(f"# {chave}={valor}\n")
+
+
+def tamanho_linha_fixa():
+    """CSV_FIXO_TAMANHO_LINHA: amostra, cada campo com a vírgula e o '\\n'."""
+    return LARGURA_AMOSTRA_FIXA + sum(1 + campo['largura'] for campo in CAMPOS) + 1
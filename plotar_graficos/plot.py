@@ -1,27 +1,36 @@
 import numpy as np
 import matplotlib.pyplot as plt
 
+from esquema_registro import ler_cabecalho
+
 # --- CONFIGURAÇÕES ---
 arquivo_para_analisar = 'dados_MPU.csv'
-taxa_de_amostragem = 5.0  # Frequência de 5 Hz
+# O intervalo entre as amostras vem do cabeçalho do arquivo (periodo_ms);
+# este valor só é usado em arquivos antigos, gravados sem o cabeçalho
+periodo_sem_cabecalho_ms = 500
 # ---------------------
 
-# Leitura do arquivo com Numpy
-dt = 1.0 / taxa_de_amostragem
+# Leitura do cabeçalho e do arquivo com Numpy
 try:
-    data = np.loadtxt(arquivo_para_analisar, delimiter=',', skiprows=1)
+    with open(arquivo_para_analisar, 'rb') as arquivo:
+        metadados, colunas, cabecalho = ler_cabecalho(arquivo)
+    data = np.loadtxt(arquivo_para_analisar, delimiter=',', skiprows=cabecalho.count(b'\n'))
 except FileNotFoundError:
     print(f"ERRO: Arquivo '{arquivo_para_analisar}' não encontrado.")
     exit()
-
-# Extrai as colunas do array numpy
-amostra = data[:, 0]
-acel_x  = data[:, 1]
-acel_y  = data[:, 2]
-acel_z  = data[:, 3]
-giro_x  = data[:, 4]
-giro_y  = data[:, 5]
-giro_z  = data[:, 6]
+if 'periodo_ms' not in metadados:
+    print(f"AVISO: Arquivo sem cabeçalho da sessão; supondo {periodo_sem_cabecalho_ms} ms entre amostras.")
+dt = float(metadados.get('periodo_ms', periodo_sem_cabecalho_ms)) / 1000.0
+
+# Extrai as colunas do array numpy pelo nome no cabeçalho (o firmware só
+# grava os canais escolhidos, então a posição de cada coluna pode mudar)
+amostra = data[:, colunas.index('Amostra')]
+acel_x  = data[:, colunas.index('Acel_X')]
+acel_y  = data[:, colunas.index('Acel_Y')]
+acel_z  = data[:, colunas.index('Acel_Z')]
+giro_x  = data[:, colunas.index('Giro_X')]
+giro_y  = data[:, colunas.index('Giro_Y')]
+giro_z  = data[:, colunas.index('Giro_Z')]
 
 # Converte giroscópio para graus (ângulo acumulado)
 angulo_x = (giro_x * dt).cumsum()
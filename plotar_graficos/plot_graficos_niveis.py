@@ -2,23 +2,27 @@ import numpy as np
 import matplotlib.pyplot as plt
 from matplotlib.gridspec import GridSpec
 
+from esquema_registro import ler_cabecalho
+
 # 1. CONFIGURAÇÕES E LEITURA DO ARQUIVO
 arquivo_para_analisar = 'nivel3.csv'
 
 # Leitura do arquivo usando Numpy
 try:
-    data = np.loadtxt(arquivo_para_analisar, delimiter=',', skiprows=1)
+    with open(arquivo_para_analisar, 'rb') as arquivo:
+        _, colunas, cabecalho = ler_cabecalho(arquivo)
+    data = np.loadtxt(arquivo_para_analisar, delimiter=',', skiprows=cabecalho.count(b'\n'))
     print(f"Arquivo '{arquivo_para_analisar}' lido com sucesso.")
 except FileNotFoundError:
     print(f"\nERRO: Arquivo '{arquivo_para_analisar}' não encontrado.")
     print("Verifique se o script e os arquivos CSV estão na mesma pasta.")
     exit()
 
-# Separa os dados em colunas individuais
-amostra = data[:, 0]
-acel_x  = data[:, 1]
-acel_y  = data[:, 2]
-acel_z  = data[:, 3]
+# Separa os dados em colunas individuais, pelo nome no cabeçalho
+amostra = data[:, colunas.index('Amostra')]
+acel_x  = data[:, colunas.index('Acel_X')]
+acel_y  = data[:, colunas.index('Acel_Y')]
+acel_z  = data[:, colunas.index('Acel_Z')]
 
 # 2. GERAÇÃO DO GRÁFICO COM LAYOUT PERSONALIZADO
 
@@ -0,0 +1,218 @@
+import struct
+import sys
+
+from esquema_registro import ESCALAS_PADRAO, escrever_cabecalho
+
+# Reconstrói em ordem cronológica os dados gravados no modo caixa-preta
+# (caixa_preta.bin) e gera um CSV no mesmo formato dos arquivos dados_MPU_*.csv
+#
+# Uso: python reconstruir_caixa_preta.py caixa_preta.bin [saida.csv]
+
+# --- FORMATO DO BLOCO (lib/Logger_Bibliotecas/caixa_preta.h) ---
+TAMANHO_BLOCO = 512
+MARCA = 0x4350504D  # "MPPC"
+# marca, sequencia, primeira_amostra, registros, periodo_ms, formato, reservado, tamanho
+CABECALHO = struct.Struct('<IIIHHBBH')
+REGISTRO = struct.Struct('<7h')      # accel_x, accel_y, accel_z, temp, gyro_x, gyro_y, gyro_z
+POSICAO_CRC = TAMANHO_BLOCO - 2      # CRC16 no fim do bloco
+FORMATO_BRUTO = 0
+FORMATO_DELTA = 1  # lib/Logger_Bibliotecas/codificador_delta.h
+FORMATO_LZ = 2     # lib/Logger_Bibliotecas/compressor_lz.h
+FORMATO_COLUNAS = 3
+CANAIS = 7
+REGISTROS_COLUNAS = 33             # CAIXA_PRETA_REGISTROS_COLUNAS
+LIMITES = struct.Struct('<14h')    # mínimo e depois máximo de cada canal
+
+# --- CONVERSÕES (iguais às de lib/mpu6050.c, constantes de lib/mpu6050.h) ---
+SENSIBILIDADE_ACEL = ESCALAS_PADRAO['acel_lsb_por_g']    # LSB/g
+SENSIBILIDADE_GIRO = ESCALAS_PADRAO['giro_lsb_por_dps']  # LSB/(°/s)
+GRAVIDADE = ESCALAS_PADRAO['gravidade_ms2']
+SENSIBILIDADE_TEMP = ESCALAS_PADRAO['temp_lsb_por_c']    # LSB/°C
+OFFSET_TEMP = ESCALAS_PADRAO['temp_offset_c'] + ESCALAS_PADRAO['temp_calibracao_c']
+# ---------------------
+
+
+def crc16(dados):
+    """CRC16 XMODEM, o mesmo de lib/FatFs_SPI/sd_driver/crc.c."""
+    crc = 0
+    for byte in dados:
+        crc ^= byte << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) if crc & 0x8000 else (crc << 1)
+            crc &= 0xFFFF
+    return crc
+
+
+def ler_varint(dados, posicao):
+    """Lê um varint (7 bits por byte); retorna o valor e a próxima posição."""
+    valor = deslocamento = 0
+    while True:
+        byte = dados[posicao]
+        posicao += 1
+        valor |= (byte & 0x7F) << deslocamento
+        if not byte & 0x80:
+            return valor, posicao
+        deslocamento += 7
+
+
+def decodificar_delta(dados, registros):
+    """Desfaz o codificador_delta.c: quadro-chave inteiro e depois diferenças
+    em zigzag + varint para cada canal."""
+    amostras = [REGISTRO.unpack_from(dados, 0)]
+    posicao = REGISTRO.size
+    for _ in range(registros - 1):
+        atual = []
+        for anterior in amostras[-1]:
+            codigo, posicao = ler_varint(dados, posicao)
+            diferenca = (codigo >> 1) ^ -(codigo & 1)
+            # Soma em 16 bits com sinal, como o firmware
+            atual.append((anterior + diferenca + 0x8000) % 0x10000 - 0x8000)
+        amostras.append(tuple(atual))
+    return amostras
+
+
+def descomprimir_lz(dados):
+    """Desfaz o compressor_lz.c: sequências de literais seguidos de uma
+    repetição (distância de 2 bytes) até acabar a entrada."""
+    saida = bytearray()
+    posicao = 0
+
+    def ler_extra(valor):
+        nonlocal posicao
+        if valor == 15:
+            while True:
+                byte = dados[posicao]
+                posicao += 1
+                valor += byte
+                if byte != 255:
+                    break
+        return valor
+
+    while posicao < len(dados):
+        controle = dados[posicao]
+        posicao += 1
+        quantidade = ler_extra(controle >> 4)
+        saida += dados[posicao:posicao + quantidade]
+        posicao += quantidade
+        if posicao >= len(dados):
+            break  # Última sequência: só literais
+        distancia = dados[posicao] | (dados[posicao + 1] << 8)
+        posicao += 2
+        comprimento = ler_extra(controle & 0x0F) + 4
+        for _ in range(comprimento):  # Pode sobrepor o que está sendo copiado
+            saida.append(saida[-distancia])
+    return bytes(saida)
+
+
+def transpor(colunas):
+    """Colunas (uma por canal) de volta para amostras."""
+    return list(zip(*colunas))
+
+
+def decodificar_lz(dados, registros):
+    """O firmware comprime as amostras canal por canal."""
+    dados = descomprimir_lz(dados)
+    return transpor(struct.unpack_from(f'<{registros}h', dados, canal * registros * 2)
+                    for canal in range(CANAIS))
+
+
+def ler_coluna(dados, registros, canal):
+    """Valores de um canal em um bloco do formato em colunas, sem ler os
+    outros: cada coluna começa sempre no mesmo lugar."""
+    posicao = LIMITES.size + canal * REGISTROS_COLUNAS * 2
+    return list(struct.unpack_from(f'<{registros}h', dados, posicao))
+
+
+def limites_colunas(dados):
+    """Mínimo e máximo de cada canal em um bloco do formato em colunas."""
+    limites = LIMITES.unpack_from(dados)
+    return limites[:CANAIS], limites[CANAIS:]
+
+
+def decodificar_colunas(dados, registros):
+    return transpor(ler_coluna(dados, registros, canal) for canal in range(CANAIS))
+
+
+def decodificar_bruto(dados, registros):
+    return [REGISTRO.unpack_from(dados, i * REGISTRO.size) for i in range(registros)]
+
+
+DECODIFICADORES = {
+    FORMATO_BRUTO: decodificar_bruto,
+    FORMATO_DELTA: decodificar_delta,
+    FORMATO_LZ: decodificar_lz,
+    FORMATO_COLUNAS: decodificar_colunas,
+}
+
+
+def ler_blocos(caminho):
+    """Lê os blocos válidos do arquivo, em ordem de sequência."""
+    blocos = []
+    with open(caminho, 'rb') as arquivo:
+        while True:
+            dados = arquivo.read(TAMANHO_BLOCO)
+            if len(dados) < TAMANHO_BLOCO:
+                break
+            (marca, sequencia, primeira, registros, periodo,
+             formato, _, tamanho) = CABECALHO.unpack_from(dados)
+            if marca != MARCA or sequencia == 0 or registros == 0:
+                continue  # Bloco nunca gravado
+            crc, = struct.unpack_from('<H', dados, POSICAO_CRC)
+            if crc != crc16(dados[:POSICAO_CRC]):
+                continue  # Bloco cortado por queda de energia
+            if formato not in DECODIFICADORES:
+                print(f"Bloco {sequencia}: formato {formato} desconhecido, ignorado.")
+                continue
+            carga = dados[CABECALHO.size:CABECALHO.size + tamanho]
+            amostras = DECODIFICADORES[formato](carga, registros)
+            blocos.append((sequencia, primeira, periodo, amostras))
+    blocos.sort(key=lambda bloco: bloco[0])
+    return blocos
+
+
+def converter(bruto):
+    ax, ay, az, temp, gx, gy, gz = bruto
+    return (ax / SENSIBILIDADE_ACEL * GRAVIDADE,
+            ay / SENSIBILIDADE_ACEL * GRAVIDADE,
+            az / SENSIBILIDADE_ACEL * GRAVIDADE,
+            gx / SENSIBILIDADE_GIRO,
+            gy / SENSIBILIDADE_GIRO,
+            gz / SENSIBILIDADE_GIRO,
+            temp / SENSIBILIDADE_TEMP + OFFSET_TEMP)
+
+
+def main():
+    if len(sys.argv) < 2:
+        print("Uso: python reconstruir_caixa_preta.py caixa_preta.bin [saida.csv]")
+        sys.exit(1)
+    entrada = sys.argv[1]
+    saida = sys.argv[2] if len(sys.argv) > 2 else 'caixa_preta.csv'
+
+    try:
+        blocos = ler_blocos(entrada)
+    except FileNotFoundError:
+        print(f"ERRO: Arquivo '{entrada}' não encontrado.")
+        sys.exit(1)
+
+    total = 0
+    with open(saida, 'w') as arquivo:
+        if blocos:
+            escrever_cabecalho(arquivo, {'periodo_ms': blocos[0][2], **ESCALAS_PADRAO})
+        arquivo.write("Amostra,Acel_X,Acel_Y,Acel_Z,Giro_X,Giro_Y,Giro_Z,Temperatura\n")
+        for sequencia, primeira, periodo, amostras in blocos:
+            for i, bruto in enumerate(amostras):
+                valores = converter(bruto)
+                arquivo.write(f"{primeira + i}," +
+                              ",".join(f"{v:.3f}" for v in valores[:6]) +
+                              f",{valores[6]:.2f}\n")
+                total += 1
+
+    if blocos:
+        print(f"{len(blocos)} blocos (sequência {blocos[0][0]} a {blocos[-1][0]}), "
+              f"{total} amostras gravadas em '{saida}'.")
+    else:
+        print("Nenhum bloco válido encontrado.")
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,112 @@
+import bisect
+import os
+import struct
+import sys
+
+from esquema_registro import LARGURA_AMOSTRA_FIXA, ler_cabecalho, tamanho_linha_fixa
+
+# Extrai um intervalo de tempo de um arquivo dados_MPU_*.csv sem ler o arquivo
+# inteiro: o índice gravado ao lado dele (dados_MPU_*.idx) diz em que posição
+# do CSV estava cada checkpoint, então basta pular para perto do início do
+# intervalo e ler dali em frente. Se o CSV foi gravado com largura fixa
+# (CSV_LARGURA_FIXA no main.c), a posição da amostra é calculada direto.
+#
+# Uso: python recortar_log.py dados_MPU_0001.csv inicio_s fim_s [saida.csv]
+#      (inicio_s e fim_s em segundos desde o início da sessão)
+
+# --- FORMATO DO ÍNDICE (entrada_indice_t em lib/Logger_Bibliotecas/log_rotativo.h) ---
+# amostra, tempo_ms, deslocamento
+ENTRADA = struct.Struct('<III')
+# CSV_FIXO_TAMANHO_LINHA (lib/Logger_Bibliotecas/csv_largura_fixa.h), pelas
+# larguras da tabela de esquema_registro.h
+TAMANHO_LINHA_FIXA = tamanho_linha_fixa()
+# ---------------------
+
+
+def ler_indice(caminho):
+    """Entradas completas do índice, em ordem."""
+    with open(caminho, 'rb') as arquivo:
+        dados = arquivo.read()
+    return [ENTRADA.unpack_from(dados, i)
+            for i in range(0, len(dados) - ENTRADA.size + 1, ENTRADA.size)]
+
+
+def amostra_no_tempo(entradas, tempo_ms):
+    """Número aproximado da amostra lida no instante pedido, interpolando
+    entre os checkpoints vizinhos."""
+    tempos = [tempo for _, tempo, _ in entradas]
+    i = max(bisect.bisect_right(tempos, tempo_ms) - 1, 0)
+    j = min(i + 1, len(entradas) - 1)
+    if j == i and i > 0:
+        i -= 1  # Depois do último checkpoint: usa o ritmo dos dois últimos
+    (amostra_i, tempo_i, _), (amostra_j, tempo_j, _) = entradas[i], entradas[j]
+    if tempo_j == tempo_i:
+        return amostra_i
+    return round(amostra_i + (tempo_ms - tempo_i) * (amostra_j - amostra_i) / (tempo_j - tempo_i))
+
+
+def deslocamento_antes(entradas, amostra):
+    """Posição no CSV de onde ler para chegar à amostra (busca binária)."""
+    amostras = [a for a, _, _ in entradas]
+    i = bisect.bisect_left(amostras, amostra) - 1
+    return entradas[max(i, 0)][2]
+
+
+def deslocamento_fixo(arquivo, amostra):
+    """Posição da amostra em um CSV de largura fixa, ou None se as linhas do
+    arquivo não tiverem largura fixa."""
+    arquivo.seek(0)
+    cabecalho = len(ler_cabecalho(arquivo)[2])
+    primeira_linha = arquivo.readline()
+    campo = primeira_linha.split(b',', 1)[0]
+    if len(primeira_linha) != TAMANHO_LINHA_FIXA or len(campo) != LARGURA_AMOSTRA_FIXA:
+        return None
+    return cabecalho + max(amostra - int(campo), 0) * TAMANHO_LINHA_FIXA
+
+
+def main():
+    if len(sys.argv) < 4:
+        print("Uso: python recortar_log.py dados_MPU_0001.csv inicio_s fim_s [saida.csv]")
+        sys.exit(1)
+    entrada = sys.argv[1]
+    inicio_ms = float(sys.argv[2]) * 1000
+    fim_ms = float(sys.argv[3]) * 1000
+    saida = sys.argv[4] if len(sys.argv) > 4 else 'recorte.csv'
+    caminho_indice = os.path.splitext(entrada)[0] + '.idx'
+
+    try:
+        entradas = ler_indice(caminho_indice)
+    except FileNotFoundError:
+        print(f"ERRO: Índice '{caminho_indice}' não encontrado.")
+        sys.exit(1)
+    if not entradas:
+        print(f"ERRO: Índice '{caminho_indice}' vazio.")
+        sys.exit(1)
+
+    primeira = amostra_no_tempo(entradas, inicio_ms)
+    ultima = amostra_no_tempo(entradas, fim_ms)
+
+    total = 0
+    try:
+        with open(entrada, 'rb') as arquivo, open(saida, 'w') as destino:
+            destino.write(ler_cabecalho(arquivo)[2].decode())  # Sessão e colunas
+            deslocamento = deslocamento_fixo(arquivo, primeira)
+            if deslocamento is None:
+                deslocamento = deslocamento_antes(entradas, primeira)
+            arquivo.seek(deslocamento)
+            for linha in arquivo:
+                amostra = int(linha.split(b',', 1)[0])
+                if amostra > ultima:
+                    break
+                if amostra >= primeira:
+                    destino.write(linha.decode())
+                    total += 1
+    except FileNotFoundError:
+        print(f"ERRO: Arquivo '{entrada}' não encontrado.")
+        sys.exit(1)
+
+    print(f"Amostras {primeira} a {ultima}: {total} linhas gravadas em '{saida}'.")
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,155 @@
+#include "cartao_ram.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "diskio.h"
+#include "hw_config.h"
+
+#define TAMANHO_SETOR 512
+#define VALOR_APAGADO 0xFF // DATA_STAT_AFTER_ERASE = 1
+
+static uint8_t *dados;
+static estatisticas_cartao_t estatisticas;
+static bool com_energia = true;
+static uint32_t setores_ate_a_queda;
+static bool queda_programada;
+static bool falhar_apagamentos;
+static uint32_t atraso_escrita_us;
+
+static int iniciar(sd_card_t *cartao) {
+    if (com_energia) cartao->m_Status &= ~STA_NOINIT;
+    return cartao->m_Status;
+}
+
+static int ler(sd_card_t *cartao, uint8_t *destino, uint64_t setor, uint32_t quantidade) {
+    if (cartao->m_Status & STA_NOINIT) return SD_BLOCK_DEVICE_ERROR_NO_INIT;
+    if (setor + quantidade > CARTAO_RAM_SETORES) return SD_BLOCK_DEVICE_ERROR_PARAMETER;
+    estatisticas.leituras++;
+    memcpy(destino, &dados[setor * TAMANHO_SETOR], (size_t)quantidade * TAMANHO_SETOR);
+    return SD_BLOCK_DEVICE_ERROR_NONE;
+}
+
+static int escrever(sd_card_t *cartao, const uint8_t *origem, uint64_t setor, uint32_t quantidade) {
+    if (cartao->m_Status & STA_NOINIT) return SD_BLOCK_DEVICE_ERROR_NO_INIT;
+    if (setor + quantidade > CARTAO_RAM_SETORES) return SD_BLOCK_DEVICE_ERROR_PARAMETER;
+    // Sem energia o firmware também pararia: o que vier depois não importa
+    if (!com_energia) return SD_BLOCK_DEVICE_ERROR_NONE;
+    if (atraso_escrita_us) usleep(atraso_escrita_us);
+    estatisticas.escritas++;
+    for (uint32_t i = 0; i < quantidade; i++) {
+        uint8_t *destino = &dados[(setor + i) * TAMANHO_SETOR];
+        if (queda_programada && setores_ate_a_queda-- == 0) {
+            memcpy(destino, origem + i * TAMANHO_SETOR, TAMANHO_SETOR / 2);
+            com_energia = false;
+            break;
+        }
+        memcpy(destino, origem + i * TAMANHO_SETOR, TAMANHO_SETOR);
+        estatisticas.setores_gravados++;
+    }
+    return SD_BLOCK_DEVICE_ERROR_NONE;
+}
+
+static sd_card_t cartao = {
+    .pcName = "0:",
+    .m_Status = STA_NOINIT,
+    .sectors = CARTAO_RAM_SETORES,
+    .au_sectors = CARTAO_RAM_AU,
+    .erase_sectors = CARTAO_RAM_AU,
+    .init = iniciar,
+    .write_blocks = escrever,
+    .read_blocks = ler,
+};
+
+size_t sd_get_num(void) {
+    return 1;
+}
+
+sd_card_t *sd_get_by_num(size_t num) {
+    return num == 0 ? &cartao : NULL;
+}
+
+bool sd_init_driver(void) {
+    return true;
+}
+
+bool sd_card_detect(sd_card_t *pSD) {
+    (void)pSD;
+    return true;
+}
+
+uint64_t sd_sectors(sd_card_t *pSD) {
+    return pSD->sectors;
+}
+
+int sd_erase_blocks(sd_card_t *pSD, uint64_t ulSectorNumber, uint32_t blockCnt) {
+    if (pSD->m_Status & STA_NOINIT) return SD_BLOCK_DEVICE_ERROR_NO_INIT;
+    if (ulSectorNumber + blockCnt > CARTAO_RAM_SETORES) return SD_BLOCK_DEVICE_ERROR_PARAMETER;
+    if (falhar_apagamentos) return SD_BLOCK_DEVICE_ERROR_ERASE;
+    if (!com_energia) return SD_BLOCK_DEVICE_ERROR_NONE;
+    estatisticas.apagamentos++;
+    estatisticas.setores_apagados += blockCnt;
+    if (blockCnt > estatisticas.maior_apagamento) estatisticas.maior_apagamento = blockCnt;
+    memset(&dados[ulSectorNumber * TAMANHO_SETOR], VALOR_APAGADO, (size_t)blockCnt * TAMANHO_SETOR);
+    return SD_BLOCK_DEVICE_ERROR_NONE;
+}
+
+DWORD get_fattime(void) {
+    return ((DWORD)(2025 - 1980) << 25) | (1u << 21) | (1u << 16);
+}
+
+FRESULT cartao_ram_formatar(void) {
+    if (!dados) dados = malloc((size_t)CARTAO_RAM_SETORES * TAMANHO_SETOR);
+    if (!dados) return FR_NOT_ENOUGH_CORE;
+    memset(dados, 0, (size_t)CARTAO_RAM_SETORES * TAMANHO_SETOR);
+    cartao_ram_religar();
+
+    static BYTE trabalho[16 * TAMANHO_SETOR];
+    const MKFS_PARM parametros = {.fmt = FM_FAT32};
+    FRESULT resultado = f_mkfs(cartao.pcName, &parametros, trabalho, sizeof(trabalho));
+    if (resultado != FR_OK) return resultado;
+    resultado = cartao_ram_montar();
+    cartao_ram_zerar_estatisticas();
+    return resultado;
+}
+
+FRESULT cartao_ram_montar(void) {
+    memset(&cartao.fatfs, 0, sizeof(cartao.fatfs));
+    return f_mount(&cartao.fatfs, cartao.pcName, 1);
+}
+
+void cartao_ram_obter_estatisticas(estatisticas_cartao_t *saida) {
+    *saida = estatisticas;
+}
+
+void cartao_ram_zerar_estatisticas(void) {
+    memset(&estatisticas, 0, sizeof(estatisticas));
+}
+
+void cartao_ram_cortar_energia(uint32_t setores) {
+    setores_ate_a_queda = setores;
+    queda_programada = true;
+}
+
+bool cartao_ram_sem_energia(void) {
+    return !com_energia;
+}
+
+void cartao_ram_religar(void) {
+    com_energia = true;
+    queda_programada = false;
+    falhar_apagamentos = false;
+    cartao.m_Status = STA_NOINIT;
+}
+
+void cartao_ram_atrasar_escritas(uint32_t us) {
+    atraso_escrita_us = us;
+}
+
+void cartao_ram_falhar_apagamentos(bool falhar) {
+    falhar_apagamentos = falhar;
+}
+
+const uint8_t *cartao_ram_setor(uint64_t setor) {
+    return &dados[setor * TAMANHO_SETOR];
+}
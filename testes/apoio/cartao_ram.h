@@ -0,0 +1,54 @@
+#ifndef CARTAO_RAM_H
+#define CARTAO_RAM_H
+
+// Cartão SD simulado em memória para os testes no computador. É o cartão 0
+// de hw_config.h, então o FatFs e glue.c rodam sobre ele como no firmware.
+// Ele conta as transações que chegam ao cartão (o que sobra depois dos caches
+// de glue.c) e pode perder a energia no meio de uma escrita: o setor em
+// andamento fica gravado pela metade e nada mais é gravado até religar.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "ff.h"
+
+#define CARTAO_RAM_SETORES (128 * 2048) // 128 MB
+#define CARTAO_RAM_AU 8192              // AU de 4 MB, como nos cartões SDHC
+
+typedef struct {
+    uint32_t leituras;            // Comandos de leitura
+    uint32_t escritas;            // Comandos de escrita
+    uint32_t setores_gravados;
+    uint32_t apagamentos;         // Comandos de apagamento
+    uint32_t setores_apagados;
+    uint32_t maior_apagamento;    // Setores do maior apagamento
+} estatisticas_cartao_t;
+
+// Apaga o cartão inteiro, formata em FAT32 e monta o volume
+FRESULT cartao_ram_formatar(void);
+
+// Monta o volume de novo, como no boot depois de uma queda de energia
+FRESULT cartao_ram_montar(void);
+
+void cartao_ram_obter_estatisticas(estatisticas_cartao_t *estatisticas);
+void cartao_ram_zerar_estatisticas(void);
+
+// A energia cai depois de mais setores gravados; o seguinte fica pela metade
+void cartao_ram_cortar_energia(uint32_t setores);
+
+// true depois que a energia caiu
+bool cartao_ram_sem_energia(void);
+
+// A energia volta: o cartão precisa ser inicializado de novo
+void cartao_ram_religar(void);
+
+// Cada escrita passa a levar pelo menos us microssegundos, como no cartão de
+// verdade; enquanto isso as outras threads rodam (0 = sem espera)
+void cartao_ram_atrasar_escritas(uint32_t us);
+
+// Faz os próximos apagamentos falharem (ou voltarem a funcionar)
+void cartao_ram_falhar_apagamentos(bool falhar);
+
+// Conteúdo de um setor do cartão
+const uint8_t *cartao_ram_setor(uint64_t setor);
+
+#endif // CARTAO_RAM_H
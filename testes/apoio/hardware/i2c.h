@@ -0,0 +1,18 @@
+#ifndef APOIO_HARDWARE_I2C_H
+#define APOIO_HARDWARE_I2C_H
+
+// hardware/i2c.h para os testes no computador. Quem usa o barramento (o teste
+// do mpu6050) implementa as duas funções com um sensor simulado.
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct i2c_inst i2c_inst_t;
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t endereco, const uint8_t *dados, size_t tamanho,
+                       bool manter);
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t endereco, uint8_t *dados, size_t tamanho,
+                      bool manter);
+
+#endif // APOIO_HARDWARE_I2C_H
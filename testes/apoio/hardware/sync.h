@@ -0,0 +1,30 @@
+#ifndef APOIO_HARDWARE_SYNC_H
+#define APOIO_HARDWARE_SYNC_H
+
+// hardware/sync.h para os testes no computador: as travas de hardware viram
+// um mutex de pthread, então memoria_estatica.c continua segura entre threads
+
+#include <pthread.h>
+#include <stdint.h>
+
+#define PICO_SPINLOCK_ID_OS1 14
+
+typedef pthread_mutex_t spin_lock_t;
+
+static inline spin_lock_t *spin_lock_instance(unsigned numero) {
+    static pthread_mutex_t trava = PTHREAD_MUTEX_INITIALIZER;
+    (void)numero;
+    return &trava;
+}
+
+static inline uint32_t spin_lock_blocking(spin_lock_t *trava) {
+    pthread_mutex_lock(trava);
+    return 0;
+}
+
+static inline void spin_unlock(spin_lock_t *trava, uint32_t estado) {
+    (void)estado;
+    pthread_mutex_unlock(trava);
+}
+
+#endif // APOIO_HARDWARE_SYNC_H
@@ -0,0 +1,12 @@
+#ifndef APOIO_HW_CONFIG_H
+#define APOIO_HW_CONFIG_H
+
+// hw_config.h para os testes no computador: um único cartão, o de cartao_ram.c
+
+#include <stddef.h>
+#include "sd_card.h"
+
+size_t sd_get_num(void);
+sd_card_t *sd_get_by_num(size_t num);
+
+#endif // APOIO_HW_CONFIG_H
@@ -0,0 +1,8 @@
+#ifndef APOIO_PICO_STDLIB_H
+#define APOIO_PICO_STDLIB_H
+
+// pico/stdlib.h para os testes no computador: só o tempo
+
+#include "pico/time.h"
+
+#endif // APOIO_PICO_STDLIB_H
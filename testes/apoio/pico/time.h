@@ -0,0 +1,52 @@
+#ifndef APOIO_PICO_TIME_H
+#define APOIO_PICO_TIME_H
+
+// pico/time.h para os testes no computador: o tempo desde o boot é o relógio
+// monotônico do sistema, em microssegundos
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <time.h>
+
+typedef uint64_t absolute_time_t;
+
+static inline uint64_t time_us_64(void) {
+    struct timespec agora;
+    clock_gettime(CLOCK_MONOTONIC, &agora);
+    return (uint64_t)agora.tv_sec * 1000000 + agora.tv_nsec / 1000;
+}
+
+static inline absolute_time_t get_absolute_time(void) {
+    return time_us_64();
+}
+
+static inline int64_t absolute_time_diff_us(absolute_time_t de, absolute_time_t ate) {
+    return (int64_t)(ate - de);
+}
+
+static inline uint32_t to_ms_since_boot(absolute_time_t instante) {
+    return (uint32_t)(instante / 1000);
+}
+
+static inline absolute_time_t delayed_by_ms(absolute_time_t instante, uint32_t ms) {
+    return instante + (uint64_t)ms * 1000;
+}
+
+static inline absolute_time_t make_timeout_time_ms(uint32_t ms) {
+    return delayed_by_ms(get_absolute_time(), ms);
+}
+
+static inline bool time_reached(absolute_time_t instante) {
+    return get_absolute_time() >= instante;
+}
+
+static inline void sleep_us(uint64_t us) {
+    struct timespec espera = {(time_t)(us / 1000000), (long)(us % 1000000) * 1000};
+    nanosleep(&espera, NULL);
+}
+
+static inline void sleep_ms(uint32_t ms) {
+    sleep_us((uint64_t)ms * 1000);
+}
+
+#endif // APOIO_PICO_TIME_H
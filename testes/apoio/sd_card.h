@@ -0,0 +1,47 @@
+#ifndef APOIO_SD_CARD_H
+#define APOIO_SD_CARD_H
+
+// sd_card.h para os testes no computador: só o que glue.c usa do driver. O
+// cartão é o de cartao_ram.c, sem SPI nem escrita assíncrona.
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "ff.h"
+
+#define SD_ASYNC_WRITE_ENABLED 0
+
+typedef struct sd_card_t sd_card_t;
+
+struct sd_card_t {
+    const char *pcName;
+    int m_Status;                                    // Card status
+    uint64_t sectors;
+    uint32_t au_sectors;                             // Allocation unit, 0 if unknown
+    uint32_t erase_sectors;                          // Erase sector size
+    FATFS fatfs;
+    int (*init)(sd_card_t *sd_card_p);
+    int (*write_blocks)(sd_card_t *sd_card_p, const uint8_t *buffer,
+                        uint64_t ulSectorNumber, uint32_t blockCnt);
+    int (*read_blocks)(sd_card_t *sd_card_p, uint8_t *buffer, uint64_t ulSectorNumber,
+                       uint32_t ulSectorCount);
+};
+
+#define SD_BLOCK_DEVICE_ERROR_NONE 0
+#define SD_BLOCK_DEVICE_ERROR_WOULD_BLOCK -5001
+#define SD_BLOCK_DEVICE_ERROR_UNSUPPORTED -5002
+#define SD_BLOCK_DEVICE_ERROR_PARAMETER -5003
+#define SD_BLOCK_DEVICE_ERROR_NO_INIT -5004
+#define SD_BLOCK_DEVICE_ERROR_NO_DEVICE -5005
+#define SD_BLOCK_DEVICE_ERROR_WRITE_PROTECTED -5006
+#define SD_BLOCK_DEVICE_ERROR_UNUSABLE -5007
+#define SD_BLOCK_DEVICE_ERROR_NO_RESPONSE -5008
+#define SD_BLOCK_DEVICE_ERROR_CRC -5009
+#define SD_BLOCK_DEVICE_ERROR_ERASE -5010
+#define SD_BLOCK_DEVICE_ERROR_WRITE -5011
+
+bool sd_card_detect(sd_card_t *pSD);
+uint64_t sd_sectors(sd_card_t *pSD);
+int sd_erase_blocks(sd_card_t *pSD, uint64_t ulSectorNumber, uint32_t blockCnt);
+bool sd_init_driver(void);
+
+#endif // APOIO_SD_CARD_H
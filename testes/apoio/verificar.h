@@ -0,0 +1,31 @@
+#ifndef VERIFICAR_H
+#define VERIFICAR_H
+
+// Verificações dos testes no computador: cada falha é mostrada e contada, e
+// o teste termina com RESULTADO_TESTE (0 se tudo passou, como o ctest espera)
+
+#include <stdio.h>
+
+static int falhas_teste;
+
+#define VERIFICAR(condicao)                                                        \
+    do {                                                                           \
+        if (!(condicao)) {                                                         \
+            printf("%s:%d: falhou: %s\n", __FILE__, __LINE__, #condicao);          \
+            falhas_teste++;                                                        \
+        }                                                                          \
+    } while (0)
+
+#define VERIFICAR_IGUAL(obtido, esperado)                                          \
+    do {                                                                           \
+        long long obtido_ = (long long)(obtido), esperado_ = (long long)(esperado); \
+        if (obtido_ != esperado_) {                                                \
+            printf("%s:%d: falhou: %s = %lld, esperado %lld\n", __FILE__, __LINE__, \
+                   #obtido, obtido_, esperado_);                                   \
+            falhas_teste++;                                                        \
+        }                                                                          \
+    } while (0)
+
+#define RESULTADO_TESTE() (falhas_teste ? 1 : 0)
+
+#endif // VERIFICAR_H
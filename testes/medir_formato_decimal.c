@@ -0,0 +1,60 @@
+// Medição (não é um teste do ctest): tempo por campo de snprintf("%.3f"),
+// decimal_escrever_float() e decimal_preencher_campo() com valores como os
+// do sensor. No computador os números só comparam os métodos entre si; no
+// RP2040 a diferença é maior, já que lá o printf faz as contas em double por
+// software.
+//   ./medir_formato_decimal [campos]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "formato_decimal.h"
+
+static double agora_ns(void) {
+    struct timespec t;
+    clock_gettime(CLOCK_MONOTONIC, &t);
+    return t.tv_sec * 1e9 + t.tv_nsec;
+}
+
+int main(int argc, char **argv) {
+    size_t campos = argc > 1 ? strtoul(argv[1], NULL, 10) : 2000000;
+    float *valores = malloc(campos * sizeof(*valores));
+    if (!valores) return 1;
+    srand(1);
+    for (size_t i = 0; i < campos; i++) {
+        valores[i] = (rand() - RAND_MAX / 2) * (20.0f / RAND_MAX); // ±10 m/s²
+    }
+
+    char texto[64];
+    volatile size_t soma = 0; // Impede o compilador de descartar a formatação
+
+    double inicio = agora_ns();
+    for (size_t i = 0; i < campos; i++) {
+        soma += (size_t)snprintf(texto, sizeof(texto), "%.3f", (double)valores[i]);
+    }
+    double printf_ns = (agora_ns() - inicio) / campos;
+
+    inicio = agora_ns();
+    for (size_t i = 0; i < campos; i++) {
+        soma += (size_t)(decimal_escrever_float(texto, valores[i], 3) - texto);
+    }
+    double escrever_ns = (agora_ns() - inicio) / campos;
+
+    char campo[] = "0000.000";
+    inicio = agora_ns();
+    for (size_t i = 0; i < campos; i++) {
+        bool negativo;
+        uint32_t magnitude = decimal_escalar(valores[i], 3, &negativo);
+        decimal_preencher_campo(campo, 8, 3, magnitude, negativo);
+        soma += (size_t)campo[7];
+    }
+    double campo_ns = (agora_ns() - inicio) / campos;
+
+    printf("%zu campos com 3 casas (FORMATO_DECIMAL_PARES %d):\n", campos, FORMATO_DECIMAL_PARES);
+    printf("  snprintf(\"%%.3f\")          %6.1f ns\n", printf_ns);
+    printf("  decimal_escrever_float()  %6.1f ns (%.1fx)\n", escrever_ns, printf_ns / escrever_ns);
+    printf("  decimal_preencher_campo() %6.1f ns (%.1fx)\n", campo_ns, printf_ns / campo_ns);
+    free(valores);
+    return 0;
+}
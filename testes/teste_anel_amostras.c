@@ -0,0 +1,177 @@
+// Anel de aquisição e decimador: leitores independentes, contagem das
+// amostras perdidas, um produtor em outra thread sem trava (cada amostra
+// lida tem que estar inteira) e as médias do decimador por canal.
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdlib.h>
+#include <string.h>
+#include "anel_amostras.h"
+#include "verificar.h"
+
+#define PUBLICACOES 200000
+
+static anel_amostras_t anel;
+
+// Todos os campos derivam do número, para notar uma amostra misturada
+static mpu6050_raw_t amostra_do_numero(uint32_t numero) {
+    int16_t v = (int16_t)(numero * 2654435761u >> 16);
+    return (mpu6050_raw_t){v, (int16_t)~v, (int16_t)(v ^ 0x5555), (int16_t)numero,
+                           (int16_t)(v + 1), (int16_t)(v - 1), (int16_t)(v * 3)};
+}
+
+static leitor_anel_t leitor_concorrente;
+
+// Normalmente espera o leitor chegar perto, como uma aquisição que o leitor
+// acompanha; a cada tantas publicações dispara mais que a capacidade do
+// anel, e o leitor perde amostras, algumas sobrescritas durante a cópia
+static void *produtor(void *argumento) {
+    (void)argumento;
+    for (uint32_t numero = 1; numero <= PUBLICACOES; numero++) {
+        if (numero % 5000 > 100) {
+            while (anel.publicadas - ((volatile leitor_anel_t *)&leitor_concorrente)->lidas > 8) {
+                sched_yield();
+            }
+        }
+        mpu6050_raw_t raw = amostra_do_numero(numero);
+        anel_publicar(&anel, &raw, MPU6050_TODOS_CANAIS);
+    }
+    return NULL;
+}
+
+static void testar_leitores(void) {
+    anel_iniciar(&anel);
+    leitor_anel_t rapido, lento;
+    anel_leitor_iniciar(&anel, &rapido);
+    anel_leitor_iniciar(&anel, &lento);
+    amostra_anel_t amostra;
+    VERIFICAR(!anel_ler(&anel, &rapido, &amostra));
+
+    // O rápido lê tudo; o lento só no fim, depois de o anel dar a volta
+    for (uint32_t numero = 1; numero <= ANEL_AMOSTRAS_CAPACIDADE + 10; numero++) {
+        mpu6050_raw_t raw = amostra_do_numero(numero);
+        VERIFICAR_IGUAL(anel_publicar(&anel, &raw, MPU6050_CANAL_ACEL), numero);
+        VERIFICAR(anel_ler(&anel, &rapido, &amostra));
+        VERIFICAR_IGUAL(amostra.numero, numero);
+        VERIFICAR_IGUAL(amostra.canais, MPU6050_CANAL_ACEL);
+        VERIFICAR(memcmp(&amostra.raw, &raw, sizeof(raw)) == 0);
+    }
+    VERIFICAR(!anel_ler(&anel, &rapido, &amostra));
+    VERIFICAR_IGUAL(rapido.perdidas, 0);
+
+    // As 10 primeiras foram sobrescritas, e a 11ª está na vaga que o
+    // produtor escreve a seguir
+    uint32_t esperada = 12;
+    while (anel_ler(&anel, &lento, &amostra)) {
+        VERIFICAR_IGUAL(amostra.numero, esperada);
+        esperada++;
+    }
+    VERIFICAR_IGUAL(esperada, ANEL_AMOSTRAS_CAPACIDADE + 11);
+    VERIFICAR_IGUAL(lento.perdidas, 11);
+
+    // Um leitor iniciado agora só vê as próximas
+    leitor_anel_t novo;
+    anel_leitor_iniciar(&anel, &novo);
+    VERIFICAR(!anel_ler(&anel, &novo, &amostra));
+}
+
+// O produtor no outro núcleo, no meio da escrita de capacidade + 1: a vaga
+// da amostra 1 já tem parte dos dados novos e ainda o número antigo
+static void testar_vaga_em_escrita(void) {
+    anel_iniciar(&anel);
+    leitor_anel_t leitor;
+    anel_leitor_iniciar(&anel, &leitor);
+    for (uint32_t numero = 1; numero <= ANEL_AMOSTRAS_CAPACIDADE; numero++) {
+        mpu6050_raw_t raw = amostra_do_numero(numero);
+        anel_publicar(&anel, &raw, MPU6050_TODOS_CANAIS);
+    }
+    amostra_anel_t *vaga = &anel.amostras[1];
+    VERIFICAR_IGUAL(vaga->numero, 1);
+    vaga->raw.accel_x = amostra_do_numero(ANEL_AMOSTRAS_CAPACIDADE + 1).accel_x;
+
+    amostra_anel_t amostra;
+    VERIFICAR(anel_ler(&anel, &leitor, &amostra));
+    VERIFICAR_IGUAL(amostra.numero, 2);
+    VERIFICAR_IGUAL(leitor.perdidas, 1);
+}
+
+static void testar_produtor_concorrente(void) {
+    anel_iniciar(&anel);
+    leitor_anel_t *leitor = &leitor_concorrente;
+    anel_leitor_iniciar(&anel, leitor);
+    pthread_t thread;
+    pthread_create(&thread, NULL, produtor, NULL);
+
+    uint32_t anterior = 0, lidas = 0, misturadas = 0;
+    amostra_anel_t amostra;
+    while (anterior < PUBLICACOES) {
+        if (!anel_ler(&anel, leitor, &amostra)) {
+            sched_yield();
+            continue;
+        }
+        mpu6050_raw_t esperada = amostra_do_numero(amostra.numero);
+        if (memcmp(&amostra.raw, &esperada, sizeof(esperada)) != 0) misturadas++;
+        VERIFICAR(amostra.numero > anterior);
+        anterior = amostra.numero;
+        lidas++;
+    }
+    pthread_join(thread, NULL);
+    printf("%lu lidas, %lu perdidas\n", (unsigned long)lidas, (unsigned long)leitor->perdidas);
+    VERIFICAR_IGUAL(misturadas, 0);
+    VERIFICAR_IGUAL(lidas + leitor->perdidas, PUBLICACOES);
+}
+
+static void testar_esquema(void) {
+    esquema_canais_t esquema = {
+        .canais = MPU6050_CANAL_ACEL | MPU6050_CANAL_TEMP,
+        .divisores = {1, 50, 2},
+    };
+    VERIFICAR_IGUAL(esquema_canais_da_vez(&esquema, 0), MPU6050_CANAL_ACEL | MPU6050_CANAL_TEMP);
+    VERIFICAR_IGUAL(esquema_canais_da_vez(&esquema, 1), MPU6050_CANAL_ACEL);
+    VERIFICAR_IGUAL(esquema_canais_da_vez(&esquema, 2), MPU6050_CANAL_ACEL); // Giro fora do esquema
+    VERIFICAR_IGUAL(esquema_canais_da_vez(&esquema, 100), MPU6050_CANAL_ACEL | MPU6050_CANAL_TEMP);
+    esquema.divisores[0] = 0; // Divisor 0 conta como 1
+    VERIFICAR_IGUAL(esquema_canais_da_vez(&esquema, 7), MPU6050_CANAL_ACEL);
+}
+
+static void testar_decimador(void) {
+    decimador_t decimador;
+    decimador_iniciar(&decimador, 4);
+    mpu6050_raw_t media;
+
+    // Arredonda a metade para longe do zero, nos dois sinais
+    static const int16_t valores[4] = {1, 2, 2, 2}; // Soma 7: 1,75 vira 2
+    for (int i = 0; i < 4; i++) {
+        mpu6050_raw_t raw = {valores[i], (int16_t)-valores[i], (int16_t)(i < 2 ? 1 : 2),
+                             100, 32767, -32768, (int16_t)i};
+        bool pronta = decimador_acrescentar(&decimador, &raw, MPU6050_TODOS_CANAIS, &media);
+        VERIFICAR_IGUAL(pronta, i == 3);
+    }
+    VERIFICAR_IGUAL(media.accel_x, 2);
+    VERIFICAR_IGUAL(media.accel_y, -2);
+    VERIFICAR_IGUAL(media.accel_z, 2);   // 1,5 vira 2
+    VERIFICAR_IGUAL(media.temp, 100);
+    VERIFICAR_IGUAL(media.gyro_x, 32767);
+    VERIFICAR_IGUAL(media.gyro_y, -32768);
+    VERIFICAR_IGUAL(media.gyro_z, 2);    // 6 / 4 = 1,5 vira 2
+
+    // A temperatura lida uma vez no bloco tem a média só dessa leitura; sem
+    // nenhuma leitura, repete a média anterior
+    for (int i = 0; i < 4; i++) {
+        mpu6050_raw_t raw = {10, 10, 10, (int16_t)(i == 2 ? 300 : -1), 20, 20, 20};
+        uint8_t canais = MPU6050_CANAL_ACEL | (i == 2 ? MPU6050_CANAL_TEMP : 0);
+        decimador_acrescentar(&decimador, &raw, canais, &media);
+    }
+    VERIFICAR_IGUAL(media.accel_x, 10);
+    VERIFICAR_IGUAL(media.temp, 300);
+    VERIFICAR_IGUAL(media.gyro_x, 32767); // Giro não lido no bloco
+}
+
+int main(void) {
+    testar_leitores();
+    testar_vaga_em_escrita();
+    testar_produtor_concorrente();
+    testar_esquema();
+    testar_decimador();
+    return RESULTADO_TESTE();
+}
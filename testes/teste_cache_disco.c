@@ -0,0 +1,86 @@
+// Conta as transações que chegam ao cartão enquanto o logger grava 1000
+// amostras como no firmware: linhas do CSV por log_escrever() e um
+// checkpoint a cada AMOSTRAS_POR_CHECKPOINT. Compilado com e sem os caches
+// de glue.c (DISK_WB_CACHE_SECTORS e DISK_RD_CACHE_SECTORS = 0).
+
+#include <stdio.h>
+#include <string.h>
+#include "cartao_ram.h"
+#include "disk_cache.h"
+#include "esquema_registro.h"
+#include "log_rotativo.h"
+#include "verificar.h"
+
+#define AMOSTRAS 1000
+#define AMOSTRAS_POR_CHECKPOINT 20 // Como em main.c
+#define CHECKPOINTS (AMOSTRAS / AMOSTRAS_POR_CHECKPOINT)
+
+#if defined(DISK_WB_CACHE_SECTORS) && DISK_WB_CACHE_SECTORS == 0
+#define COM_CACHE 0
+#else
+#define COM_CACHE 1
+#endif
+
+int main(void) {
+    VERIFICAR_IGUAL(cartao_ram_formatar(), FR_OK);
+
+    static const config_log_t config = {
+        .prefixo = "dados_MPU_",
+        .extensao = ".csv",
+        .cabecalho = "Amostra,Acel_X,Acel_Y,Acel_Z,Giro_X,Giro_Y,Giro_Z,Temperatura\n",
+        .tamanho_maximo = 1024 * 1024,
+        .tamanho_prealocado = 1024 * 1024,
+        .checkpoint = "dados_MPU.chk",
+        .extensao_indice = ".idx",
+    };
+    static log_rotativo_t log;
+    VERIFICAR_IGUAL(log_abrir(&log, &config), FR_OK);
+
+    disk_cache_stats_t cache_antes, cache_depois;
+    disk_cache_get_stats(&cache_antes);
+    cartao_ram_zerar_estatisticas();
+
+    uint32_t bytes = 0;
+    for (uint32_t amostra = 1; amostra <= AMOSTRAS; amostra++) {
+        mpu6050_data_t dados = {
+            .accel_x = 0.01f * amostra, .accel_y = -0.02f * amostra, .accel_z = 9.81f,
+            .gyro_x = 0.5f, .gyro_y = -0.25f, .gyro_z = amostra % 7,
+            .temp_c = 25.5f,
+        };
+        char linha[128];
+        UINT tamanho = registro_formatar_csv(linha, sizeof(linha), amostra, &dados,
+                                             MPU6050_TODOS_CANAIS);
+        bytes += tamanho;
+        VERIFICAR_IGUAL(log_escrever(&log, linha, tamanho), FR_OK);
+        if (amostra % AMOSTRAS_POR_CHECKPOINT == 0) {
+            VERIFICAR_IGUAL(log_checkpoint(&log, amostra), FR_OK);
+        }
+    }
+
+    estatisticas_cartao_t cartao;
+    cartao_ram_obter_estatisticas(&cartao);
+    disk_cache_get_stats(&cache_depois);
+    uint32_t setores_fatfs = cache_depois.writes - cache_antes.writes;
+    uint32_t escritas_glue = cache_depois.device_writes - cache_antes.device_writes;
+    printf("%s: %lu bytes, %lu setores escritos pelo FatFs, %lu escritas no cartao "
+           "(%lu setores), %.1f por checkpoint\n",
+           COM_CACHE ? "com cache" : "sem cache", (unsigned long)bytes,
+           (unsigned long)setores_fatfs, (unsigned long)cartao.escritas,
+           (unsigned long)cartao.setores_gravados, (double)cartao.escritas / CHECKPOINTS);
+
+    // O contador de glue.c é o que o firmware mostra: tem que bater com o cartão
+    VERIFICAR_IGUAL(escritas_glue, cartao.escritas);
+    // Tudo o que o FatFs escreveu chegou ao cartão no último checkpoint
+    VERIFICAR(cartao.setores_gravados <= setores_fatfs);
+#if COM_CACHE
+    // Entre dois checkpoints o cache guarda as regravações do mesmo setor e
+    // junta setores vizinhos: sobram os setores novos de dados e um setor do
+    // arquivo de dados, do índice e do checkpoint (mais as entradas de
+    // diretório dos três) a cada sincronização
+    VERIFICAR(cartao.escritas <= bytes / 512 + 6 * CHECKPOINTS);
+    VERIFICAR(cartao.escritas < setores_fatfs);
+#endif
+
+    VERIFICAR_IGUAL(log_fechar(&log), FR_OK);
+    return RESULTADO_TESTE();
+}
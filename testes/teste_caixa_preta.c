@@ -0,0 +1,108 @@
+// Queda de energia na caixa-preta: para cada setor gravado durante algumas
+// voltas do anel, a energia cai no meio dele, o cartão é montado de novo e
+// caixa_preta_abrir() tem que continuar depois do bloco válido mais novo,
+// encontrado aqui lendo o arquivo inteiro.
+
+#include <stddef.h>
+#include <stdio.h>
+#include "caixa_preta.h"
+#include "cartao_ram.h"
+#include "crc.h"
+#include "verificar.h"
+
+#define ARQUIVO "caixa.bin"
+#define BLOCOS 4
+#define VOLTAS 3
+#define AMOSTRAS (BLOCOS * CAIXA_PRETA_REGISTROS * VOLTAS)
+
+static caixa_preta_t caixa;
+
+// Sequência e última amostra do bloco válido mais novo do arquivo
+static uint32_t mais_nova_no_arquivo(uint32_t *ultima_amostra) {
+    static FIL arquivo;
+    static bloco_caixa_preta_t bloco;
+    uint32_t mais_nova = 0;
+    *ultima_amostra = 0;
+    if (f_open(&arquivo, ARQUIVO, FA_READ) != FR_OK) return 0;
+    for (uint32_t i = 0; i < BLOCOS; i++) {
+        UINT lidos;
+        if (f_read(&arquivo, &bloco, sizeof(bloco), &lidos) != FR_OK || lidos < sizeof(bloco)) break;
+        if (bloco.marca != CAIXA_PRETA_MARCA ||
+            bloco.crc != crc16((const char *)&bloco, offsetof(bloco_caixa_preta_t, crc))) {
+            continue;
+        }
+        if (bloco.sequencia > mais_nova) {
+            mais_nova = bloco.sequencia;
+            *ultima_amostra = bloco.primeira_amostra + bloco.registros - 1;
+        }
+    }
+    f_close(&arquivo);
+    return mais_nova;
+}
+
+static mpu6050_raw_t amostra_simulada(uint32_t amostra) {
+    return (mpu6050_raw_t){(int16_t)amostra, (int16_t)-amostra, 16384, 2000,
+                           (int16_t)(amostra * 3), 0, (int16_t)(amostra % 5)};
+}
+
+// Cria o anel do zero e grava até a energia cair (ou até o fim). Retorna a
+// última amostra que terminou de gravar antes da queda.
+static uint32_t gravar_ate_a_queda(uint32_t setores) {
+    cartao_ram_religar();
+    VERIFICAR_IGUAL(cartao_ram_montar(), FR_OK);
+    f_unlink(ARQUIVO);
+    VERIFICAR_IGUAL(caixa_preta_abrir(&caixa, ARQUIVO, BLOCOS, 10, CAIXA_PRETA_BRUTO), FR_OK);
+
+    cartao_ram_zerar_estatisticas();
+    cartao_ram_cortar_energia(setores);
+    uint32_t ultima_gravada = 0;
+    for (uint32_t amostra = 1; amostra <= AMOSTRAS && !cartao_ram_sem_energia(); amostra++) {
+        mpu6050_raw_t raw = amostra_simulada(amostra);
+        caixa_preta_gravar(&caixa, amostra, &raw);
+        if (!cartao_ram_sem_energia()) ultima_gravada = amostra;
+    }
+    return ultima_gravada;
+}
+
+int main(void) {
+    VERIFICAR_IGUAL(cartao_ram_formatar(), FR_OK);
+
+    // Setores gravados nas voltas completas, sem queda
+    gravar_ate_a_queda(UINT32_MAX);
+    estatisticas_cartao_t cartao;
+    cartao_ram_obter_estatisticas(&cartao);
+    uint32_t total_setores = cartao.setores_gravados;
+    VERIFICAR(total_setores >= AMOSTRAS);
+
+    int quedas = 0;
+    for (uint32_t setores = 0; setores < total_setores; setores++) {
+        uint32_t ultima_gravada = gravar_ate_a_queda(setores);
+        if (!cartao_ram_sem_energia()) continue;
+        quedas++;
+
+        cartao_ram_religar();
+        VERIFICAR_IGUAL(cartao_ram_montar(), FR_OK);
+        uint32_t ultima_amostra;
+        uint32_t esperada = mais_nova_no_arquivo(&ultima_amostra);
+        // Perde no máximo o bloco que estava sendo regravado
+        VERIFICAR(ultima_amostra + CAIXA_PRETA_REGISTROS >= ultima_gravada);
+
+        VERIFICAR_IGUAL(caixa_preta_abrir(&caixa, ARQUIVO, BLOCOS, 10, CAIXA_PRETA_BRUTO), FR_OK);
+        if (caixa.bloco.sequencia != esperada + 1) {
+            printf("queda no setor %lu: continuou na sequência %lu, esperada %lu\n",
+                   (unsigned long)setores, (unsigned long)caixa.bloco.sequencia,
+                   (unsigned long)esperada + 1);
+        }
+        VERIFICAR_IGUAL(caixa.bloco.sequencia, esperada + 1);
+
+        // A amostra seguinte vai para um bloco novo, que passa a ser o mais novo
+        mpu6050_raw_t raw = amostra_simulada(ultima_gravada + 1);
+        VERIFICAR_IGUAL(caixa_preta_gravar(&caixa, ultima_gravada + 1, &raw), FR_OK);
+        VERIFICAR_IGUAL(caixa_preta_fechar(&caixa), FR_OK);
+        VERIFICAR_IGUAL(mais_nova_no_arquivo(&ultima_amostra), esperada + 1);
+        VERIFICAR_IGUAL(ultima_amostra, ultima_gravada + 1);
+    }
+    printf("%d quedas de energia em %lu setores gravados\n", quedas, (unsigned long)total_setores);
+    VERIFICAR(quedas > 0);
+    return RESULTADO_TESTE();
+}
@@ -0,0 +1,96 @@
+// Codificador delta da caixa-preta: um decodificador com o formato descrito
+// em codificador_delta.h (o mesmo de plotar_graficos/reconstruir_caixa_preta.py)
+// tem que reconstruir cada amostra, inclusive com saltos de ponta a ponta do
+// int16, e um bloco cheio recusa a amostra sem mudar nada.
+
+#include <stdlib.h>
+#include <string.h>
+#include "codificador_delta.h"
+#include "verificar.h"
+
+#define CANAIS 7
+#define AMOSTRAS 500
+
+static uint16_t ler_varint(const uint8_t *dados, size_t *posicao) {
+    uint16_t valor = 0;
+    for (int deslocamento = 0;; deslocamento += 7) {
+        uint8_t byte = dados[(*posicao)++];
+        valor |= (uint16_t)((byte & 0x7F) << deslocamento);
+        if (!(byte & 0x80)) return valor;
+    }
+}
+
+// Decodifica o bloco inteiro; retorna quantas amostras leu
+static size_t decodificar(const uint8_t *dados, size_t tamanho, mpu6050_raw_t *saida) {
+    size_t posicao = 0, amostras = 0;
+    int16_t valores[CANAIS];
+    while (posicao < tamanho) {
+        for (int i = 0; i < CANAIS; i++) {
+            if (amostras == 0) {
+                valores[i] = (int16_t)(dados[posicao] | (dados[posicao + 1] << 8));
+                posicao += 2;
+            } else {
+                uint16_t z = ler_varint(dados, &posicao);
+                int16_t diferenca = (int16_t)((z >> 1) ^ (uint16_t)-(z & 1));
+                valores[i] = (int16_t)(uint16_t)(valores[i] + diferenca);
+            }
+        }
+        memcpy(&saida[amostras++], valores, sizeof(valores)); // Ordem de mpu6050_raw_t
+    }
+    return amostras;
+}
+
+int main(void) {
+    static mpu6050_raw_t amostras[AMOSTRAS], decodificadas[AMOSTRAS];
+    srand(1);
+    int16_t *valores = (int16_t *)&amostras[0];
+    for (int i = 0; i < CANAIS; i++) valores[i] = (int16_t)(rand() - RAND_MAX / 2);
+    for (int n = 1; n < AMOSTRAS; n++) {
+        int16_t *atual = (int16_t *)&amostras[n];
+        const int16_t *anterior = (const int16_t *)&amostras[n - 1];
+        for (int i = 0; i < CANAIS; i++) {
+            if (n % 100 == 50) {
+                // Salto de ponta a ponta: a diferença dá a volta em 16 bits
+                atual[i] = anterior[i] >= 0 ? -32768 : 32767;
+            } else {
+                atual[i] = (int16_t)(anterior[i] + rand() % 127 - 63); // Até ±63: 1 byte
+            }
+        }
+    }
+
+    static uint8_t bloco[AMOSTRAS * DELTA_MAXIMO_POR_AMOSTRA];
+    codificador_delta_t codificador;
+    delta_iniciar(&codificador, bloco, sizeof(bloco));
+    for (int n = 0; n < AMOSTRAS; n++) {
+        uint16_t antes = codificador.tamanho;
+        VERIFICAR(delta_acrescentar(&codificador, &amostras[n]));
+        uint16_t usado = codificador.tamanho - antes;
+        if (n == 0) {
+            VERIFICAR_IGUAL(usado, DELTA_TAMANHO_QUADRO_CHAVE);
+        } else if (n % 100 == 50 || n % 100 == 51) {
+            VERIFICAR(usado <= DELTA_MAXIMO_POR_AMOSTRA);
+        } else {
+            VERIFICAR_IGUAL(usado, CANAIS);
+        }
+    }
+    VERIFICAR_IGUAL(codificador.registros, AMOSTRAS);
+    VERIFICAR_IGUAL(decodificar(bloco, codificador.tamanho, decodificadas), AMOSTRAS);
+    VERIFICAR(memcmp(decodificadas, amostras, sizeof(amostras)) == 0);
+
+    // Bloco cheio: a amostra que não cabe é recusada e o estado não muda
+    uint8_t pequeno[DELTA_TAMANHO_QUADRO_CHAVE + 10];
+    delta_iniciar(&codificador, pequeno, sizeof(pequeno));
+    VERIFICAR(delta_acrescentar(&codificador, &amostras[0]));
+    VERIFICAR(delta_acrescentar(&codificador, &amostras[1])); // 7 bytes
+    codificador_delta_t antes = codificador;
+    VERIFICAR(!delta_acrescentar(&codificador, &amostras[2]));
+    VERIFICAR(memcmp(&antes, &codificador, sizeof(antes)) == 0);
+    VERIFICAR_IGUAL(decodificar(pequeno, codificador.tamanho, decodificadas), 2);
+    VERIFICAR(memcmp(decodificadas, amostras, 2 * sizeof(amostras[0])) == 0);
+
+    // Quadro-chave que não cabe
+    delta_iniciar(&codificador, pequeno, DELTA_TAMANHO_QUADRO_CHAVE - 1);
+    VERIFICAR(!delta_acrescentar(&codificador, &amostras[0]));
+    VERIFICAR_IGUAL(codificador.registros, 0);
+    return RESULTADO_TESTE();
+}
@@ -0,0 +1,96 @@
+// Compressor LZ da caixa-preta: um descompressor com o formato descrito em
+// compressor_lz.h (o mesmo de plotar_graficos/reconstruir_caixa_preta.py) tem
+// que devolver a entrada de blocos aleatórios e repetitivos, com campos
+// longos que passam de 15, e a falta de espaço tem que dar -1 sem escrever
+// além da capacidade.
+
+#include <stdlib.h>
+#include <string.h>
+#include "compressor_lz.h"
+#include "verificar.h"
+
+// Soma os bytes extras de um campo de 4 bits que chegou a 15
+static size_t ler_extra(const uint8_t *dados, size_t *posicao, size_t valor) {
+    if (valor < 15) return valor;
+    uint8_t byte;
+    do {
+        byte = dados[(*posicao)++];
+        valor += byte;
+    } while (byte == 255);
+    return valor;
+}
+
+// Descomprime; retorna o tamanho da saída ou -1 se o bloco for inválido
+static int descompactar(const uint8_t *dados, size_t tamanho, uint8_t *saida) {
+    size_t posicao = 0, o = 0;
+    while (posicao < tamanho) {
+        uint8_t controle = dados[posicao++];
+        size_t literais = ler_extra(dados, &posicao, controle >> 4);
+        memcpy(&saida[o], &dados[posicao], literais);
+        posicao += literais;
+        o += literais;
+        if (posicao == tamanho) break; // Última sequência, só literais
+        size_t distancia = dados[posicao] | (dados[posicao + 1] << 8);
+        posicao += 2;
+        size_t comprimento = ler_extra(dados, &posicao, controle & 0x0F) + 4;
+        if (distancia == 0 || distancia > o) return -1;
+        for (size_t i = 0; i < comprimento; i++, o++) saida[o] = saida[o - distancia]; // Pode sobrepor
+    }
+    return (int)o;
+}
+
+static uint8_t comprimido[2 * LZ_ENTRADA_MAXIMA], restaurado[LZ_ENTRADA_MAXIMA + 64];
+static tabela_lz_t tabela;
+
+// Comprime, descomprime e compara; retorna o tamanho comprimido
+static int ida_e_volta(const uint8_t *entrada, uint16_t tamanho) {
+    int n = lz_compactar(entrada, tamanho, comprimido, sizeof(comprimido), &tabela);
+    VERIFICAR(n > 0);
+    if (n <= 0) return n;
+    VERIFICAR_IGUAL(descompactar(comprimido, (size_t)n, restaurado), tamanho);
+    VERIFICAR(memcmp(restaurado, entrada, tamanho) == 0);
+    return n;
+}
+
+int main(void) {
+    static uint8_t entrada[LZ_ENTRADA_MAXIMA + 1];
+    srand(1);
+
+    // Aleatório: só literais, com a quantidade continuada em bytes extras
+    for (size_t i = 0; i < sizeof(entrada); i++) entrada[i] = (uint8_t)rand();
+    for (uint16_t tamanho = 0; tamanho <= LZ_ENTRADA_MAXIMA; tamanho += 97) {
+        ida_e_volta(entrada, tamanho);
+    }
+    ida_e_volta(entrada, LZ_ENTRADA_MAXIMA);
+
+    // Um byte repetido: repetição sobreposta (distância 1) e comprimento longo
+    memset(entrada, 'A', LZ_ENTRADA_MAXIMA);
+    VERIFICAR(ida_e_volta(entrada, LZ_ENTRADA_MAXIMA) < 32);
+
+    // Linhas de texto repetidas a várias distâncias
+    size_t n = 0;
+    while (n < LZ_ENTRADA_MAXIMA) {
+        int linha = rand() % 40;
+        n += (size_t)snprintf((char *)&entrada[n], LZ_ENTRADA_MAXIMA + 1 - n,
+                              "%d,%d.%03d,-0.%03d\n", linha, linha % 10, linha * 7, linha);
+    }
+    VERIFICAR(ida_e_volta(entrada, LZ_ENTRADA_MAXIMA) < LZ_ENTRADA_MAXIMA / 2);
+
+    // Pouco espaço: -1 em todas as capacidades menores que o necessário, sem
+    // escrever além delas
+    for (size_t i = 0; i < 600; i++) entrada[i] = (uint8_t)(i % 50 < 20 ? i % 50 : (size_t)rand());
+    int necessario = lz_compactar(entrada, 600, comprimido, sizeof(comprimido), &tabela);
+    VERIFICAR(necessario > 0);
+    for (int capacidade = 0; capacidade < necessario; capacidade++) {
+        memset(comprimido, 0xEE, sizeof(comprimido));
+        VERIFICAR_IGUAL(lz_compactar(entrada, 600, comprimido, (uint16_t)capacidade, &tabela), -1);
+        VERIFICAR_IGUAL(comprimido[capacidade], 0xEE);
+    }
+    VERIFICAR_IGUAL(lz_compactar(entrada, 600, comprimido, (uint16_t)necessario, &tabela),
+                    necessario);
+
+    // Entrada maior que a janela
+    VERIFICAR_IGUAL(lz_compactar(entrada, LZ_ENTRADA_MAXIMA + 1, comprimido, sizeof(comprimido),
+                                 &tabela), -1);
+    return RESULTADO_TESTE();
+}
@@ -0,0 +1,55 @@
+// Confere o crc16() da tabela contra um modelo do sniffer de DMA do RP2040,
+// que o driver usa para o CRC dos blocos de dados (spi_transfer_crc16() e a
+// leitura em sequência, que semeia o sniffer com update_crc16())
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "crc.h"
+#include "verificar.h"
+
+// O sniffer em CRC-16-CCITT com byte swap e inversão da saída desligados:
+// cada byte entra pelo bit mais significativo, polinômio x^16 + x^12 + x^5 + 1,
+// sem reflexão nem XOR final, a partir do valor escrito em sniff_data
+static uint16_t modelo_sniffer(uint16_t semente, const uint8_t *dados, size_t tamanho) {
+    uint16_t crc = semente;
+    for (size_t i = 0; i < tamanho; i++) {
+        crc ^= (uint16_t)dados[i] << 8;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+        }
+    }
+    return crc;
+}
+
+int main(void) {
+    // Valor de referência do CRC-16/XMODEM
+    const char *referencia = "123456789";
+    VERIFICAR_IGUAL(crc16(referencia, 9), 0x31C3);
+    VERIFICAR_IGUAL(modelo_sniffer(0, (const uint8_t *)referencia, 9), 0x31C3);
+
+    uint8_t bloco[512 + 2];
+    srand(1);
+    for (int rodada = 0; rodada < 2000; rodada++) {
+        for (size_t i = 0; i < 512; i++) bloco[i] = (uint8_t)rand();
+        // Blocos com bytes só de 0x00 ou 0xFF também, como setores apagados
+        if (rodada % 100 == 1) memset(bloco, rodada & 2 ? 0xFF : 0x00, 512);
+        size_t tamanho = rodada % 4 ? 512 : (size_t)(rand() % 513);
+
+        uint16_t tabela = crc16((const char *)bloco, (int)tamanho);
+        VERIFICAR_IGUAL(modelo_sniffer(0, bloco, tamanho), tabela);
+
+        // Leitura em sequência: os primeiros bytes do bloco chegam com o
+        // anterior, e o sniffer continua a partir do CRC deles
+        size_t corte = tamanho ? (size_t)rand() % tamanho : 0;
+        unsigned short semente = 0;
+        update_crc16(&semente, (const char *)bloco, corte);
+        VERIFICAR_IGUAL(modelo_sniffer(semente, bloco + corte, tamanho - corte), tabela);
+
+        // O CRC16 enviado depois dos dados (MSB primeiro) zera o resto
+        bloco[tamanho] = (uint8_t)(tabela >> 8);
+        bloco[tamanho + 1] = (uint8_t)tabela;
+        VERIFICAR_IGUAL(modelo_sniffer(0, bloco, tamanho + 2), 0);
+    }
+    return RESULTADO_TESTE();
+}
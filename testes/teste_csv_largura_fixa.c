@@ -0,0 +1,91 @@
+// CSV de largura fixa: todas as linhas têm CSV_FIXO_TAMANHO_LINHA bytes com
+// as vírgulas no mesmo lugar, e cada campo, sem os zeros à esquerda, é o
+// mesmo texto da linha normal de registro_formatar_csv(). O que não cabe no
+// campo é saturado.
+
+#include <stdlib.h>
+#include <string.h>
+#include "csv_largura_fixa.h"
+#include "esquema_registro.h"
+#include "verificar.h"
+
+// Tira os zeros à esquerda de um campo ("-009.623" vira "-9.623")
+static void sem_zeros(const char *campo, size_t largura, char *saida) {
+    size_t i = 0;
+    if (campo[0] == '-') *saida++ = campo[i++];
+    while (i + 1 < largura && campo[i] == '0' && campo[i + 1] != '.') i++;
+    memcpy(saida, campo + i, largura - i);
+    saida[largura - i] = '\0';
+}
+
+// Confere a linha fixa contra a linha normal, campo a campo
+static void conferir_linha(const char *fixa, uint32_t amostra, const mpu6050_data_t *dados) {
+    VERIFICAR_IGUAL(strlen(fixa), CSV_FIXO_TAMANHO_LINHA);
+    VERIFICAR_IGUAL(fixa[CSV_FIXO_TAMANHO_LINHA - 1], '\n');
+
+    char normal[128];
+    registro_formatar_csv(normal, sizeof(normal), amostra, dados, MPU6050_TODOS_CANAIS);
+    char *resto_normal = normal;
+    const char *campo = fixa;
+    size_t campos = 0;
+    while (*campo) {
+        size_t largura = strcspn(campo, ",\n");
+        size_t tamanho_normal = strcspn(resto_normal, ",\n");
+        char obtido[32], esperado[32];
+        sem_zeros(campo, largura, obtido);
+        memcpy(esperado, resto_normal, tamanho_normal);
+        esperado[tamanho_normal] = '\0';
+        if (strcmp(obtido, esperado) != 0) {
+            printf("amostra %lu, campo %zu: \"%.*s\", esperado \"%s\"\n", (unsigned long)amostra,
+                   campos, (int)largura, campo, esperado);
+            falhas_teste++;
+        }
+        campo += largura + 1;
+        resto_normal += tamanho_normal + 1;
+        campos++;
+    }
+    VERIFICAR_IGUAL(campos, 1 + ESQUEMA_CANAIS);
+}
+
+int main(void) {
+    static linha_csv_fixa_t linha;
+    csv_fixo_iniciar(&linha);
+    VERIFICAR_IGUAL(strlen(linha.texto), CSV_FIXO_TAMANHO_LINHA);
+
+    // Valores dentro das faixas do sensor, com as vírgulas sempre no lugar
+    char modelo[CSV_FIXO_TAMANHO_LINHA + 1];
+    strcpy(modelo, linha.texto);
+    srand(1);
+    for (uint32_t amostra = 1; amostra <= 20000; amostra++) {
+        float escala = (rand() % 4 == 0) ? 0.001f : 1.0f; // Muitos perto de zero, com sinal
+        mpu6050_data_t dados = {
+            .accel_x = (rand() - RAND_MAX / 2) * (39.0f / RAND_MAX) * escala,
+            .accel_y = (rand() - RAND_MAX / 2) * (39.0f / RAND_MAX) * escala,
+            .accel_z = (rand() - RAND_MAX / 2) * (39.0f / RAND_MAX) * escala,
+            .gyro_x = (rand() - RAND_MAX / 2) * (500.0f / RAND_MAX) * escala,
+            .gyro_y = (rand() - RAND_MAX / 2) * (500.0f / RAND_MAX) * escala,
+            .gyro_z = (rand() - RAND_MAX / 2) * (500.0f / RAND_MAX) * escala,
+            .temp_c = (rand() - RAND_MAX / 2) * (120.0f / RAND_MAX) * escala,
+        };
+        const char *texto = csv_fixo_preencher(&linha, amostra * 104729u, &dados);
+        conferir_linha(texto, amostra * 104729u, &dados);
+        for (size_t i = 0; i < CSV_FIXO_TAMANHO_LINHA; i++) {
+            if ((modelo[i] == ',' || modelo[i] == '\n') && texto[i] != modelo[i]) {
+                VERIFICAR_IGUAL(texto[i], modelo[i]);
+                break;
+            }
+        }
+    }
+
+    // -0.000 tem o mesmo sinal da linha normal
+    mpu6050_data_t quase_zero = {.accel_x = -0.0004f, .gyro_z = -0.0f, .temp_c = -0.001f};
+    conferir_linha(csv_fixo_preencher(&linha, 7, &quase_zero), 7, &quase_zero);
+    VERIFICAR(strncmp(linha.texto + CSV_FIXO_LARGURA_AMOSTRA + 1, "-000.000,", 9) == 0);
+
+    // Fora da largura do campo: o maior valor que cabe, com o sinal
+    mpu6050_data_t fora = {.accel_x = 12345.0f, .accel_y = -12345.0f, .temp_c = 1000.0f};
+    const char *texto = csv_fixo_preencher(&linha, 4294967295u, &fora);
+    VERIFICAR(strncmp(texto, "4294967295,9999.999,-999.999,", 29) == 0);
+    VERIFICAR(strcmp(texto + CSV_FIXO_TAMANHO_LINHA - 7, "999.99\n") == 0);
+    return RESULTADO_TESTE();
+}
@@ -0,0 +1,116 @@
+// Esquema do registro: cabeçalho e linhas do CSV com cada máscara de canais,
+// comparados com o printf, linhas cortadas quando o destino é pequeno e o
+// empacotamento do fluxo bruto (ordem da tabela, little-endian).
+
+#include <string.h>
+#include "esquema_registro.h"
+#include "verificar.h"
+
+static const mpu6050_data_t DADOS = {
+    .accel_x = 9.8066f, .accel_y = -0.0004f, .accel_z = -12.5f,
+    .gyro_x = 249.9f, .gyro_y = -0.125f, .gyro_z = 0.0f,
+    .temp_c = 31.456f,
+};
+
+// Linha esperada, montada com o printf na ordem das colunas da tabela
+static void linha_printf(char *destino, size_t tamanho, uint32_t amostra, uint8_t canais) {
+    size_t n = (size_t)snprintf(destino, tamanho, "%lu", (unsigned long)amostra);
+    if (canais & MPU6050_CANAL_ACEL) {
+        n += (size_t)snprintf(destino + n, tamanho - n, ",%.3f,%.3f,%.3f", DADOS.accel_x,
+                              DADOS.accel_y, DADOS.accel_z);
+    }
+    if (canais & MPU6050_CANAL_GIRO) {
+        n += (size_t)snprintf(destino + n, tamanho - n, ",%.3f,%.3f,%.3f", DADOS.gyro_x,
+                              DADOS.gyro_y, DADOS.gyro_z);
+    }
+    if (canais & MPU6050_CANAL_TEMP) {
+        n += (size_t)snprintf(destino + n, tamanho - n, ",%.2f", DADOS.temp_c);
+    }
+    snprintf(destino + n, tamanho - n, "\n");
+}
+
+static void testar_cabecalho(void) {
+    static const char COMPLETO[] = "Amostra,Acel_X,Acel_Y,Acel_Z,Giro_X,Giro_Y,Giro_Z,Temperatura\n";
+    char texto[128];
+    size_t n = registro_cabecalho_csv(texto, sizeof(texto), MPU6050_TODOS_CANAIS);
+    VERIFICAR(strcmp(texto, COMPLETO) == 0);
+    VERIFICAR_IGUAL(n, strlen(texto));
+    n = registro_cabecalho_csv(texto, sizeof(texto), MPU6050_CANAL_TEMP);
+    VERIFICAR(strcmp(texto, "Amostra,Temperatura\n") == 0);
+    VERIFICAR_IGUAL(n, strlen(texto));
+    n = registro_cabecalho_csv(texto, sizeof(texto), 0);
+    VERIFICAR(strcmp(texto, "Amostra\n") == 0);
+
+    // Cortado: o que coube, sempre terminado
+    for (size_t tamanho = 1; tamanho <= sizeof(COMPLETO); tamanho++) {
+        memset(texto, '#', sizeof(texto));
+        n = registro_cabecalho_csv(texto, tamanho, MPU6050_TODOS_CANAIS);
+        VERIFICAR_IGUAL(n, strlen(texto));
+        VERIFICAR(n < tamanho);
+        VERIFICAR(strncmp(texto, COMPLETO, n) == 0);
+    }
+}
+
+static void testar_linhas(void) {
+    for (uint8_t canais = 0; canais <= MPU6050_TODOS_CANAIS; canais++) {
+        char obtido[128], esperado[128];
+        size_t n = registro_formatar_csv(obtido, sizeof(obtido), 4294967295u, &DADOS, canais);
+        linha_printf(esperado, sizeof(esperado), 4294967295u, canais);
+        if (strcmp(obtido, esperado) != 0) {
+            printf("canais %u: \"%s\", printf \"%s\"\n", canais, obtido, esperado);
+            falhas_teste++;
+        }
+        VERIFICAR_IGUAL(n, strlen(obtido));
+    }
+
+    // Destino pequeno: a linha para no último campo inteiro que coube, sem
+    // o '\n', e nunca passa do tamanho
+    char completa[128];
+    linha_printf(completa, sizeof(completa), 123, MPU6050_TODOS_CANAIS);
+    for (size_t tamanho = 0; tamanho <= strlen(completa) + 1; tamanho++) {
+        char texto[128];
+        memset(texto, '#', sizeof(texto));
+        size_t n = registro_formatar_csv(texto, tamanho, 123, &DADOS, MPU6050_TODOS_CANAIS);
+        VERIFICAR(texto[tamanho] == '#');
+        if (tamanho == 0) continue;
+        VERIFICAR_IGUAL(n, strlen(texto));
+        VERIFICAR(n < tamanho);
+        VERIFICAR(strncmp(texto, completa, n) == 0);
+        VERIFICAR(n == 0 || completa[n] == ',' || completa[n] == '\n' || completa[n] == '\0');
+        bool com_fim = n > 0 && texto[n - 1] == '\n'; // Só a linha inteira termina a linha
+        VERIFICAR_IGUAL(com_fim, n == strlen(completa));
+    }
+}
+
+static void testar_empacotamento(void) {
+    mpu6050_raw_t raw = {0x0102, -2, 0x0304, 0x0A0B, 0x0506, -32768, 0x0708};
+    for (uint8_t canais = 0; canais <= MPU6050_TODOS_CANAIS; canais++) {
+        uint8_t esperado[14];
+        uint16_t n = 0;
+        // Ordem da tabela: aceleração, giroscópio e temperatura
+        const int16_t valores[7] = {raw.accel_x, raw.accel_y, raw.accel_z, raw.gyro_x,
+                                    raw.gyro_y,  raw.gyro_z,  raw.temp};
+        const uint8_t grupos[7] = {MPU6050_CANAL_ACEL, MPU6050_CANAL_ACEL, MPU6050_CANAL_ACEL,
+                                   MPU6050_CANAL_GIRO, MPU6050_CANAL_GIRO, MPU6050_CANAL_GIRO,
+                                   MPU6050_CANAL_TEMP};
+        for (int i = 0; i < 7; i++) {
+            if (!(canais & grupos[i])) continue;
+            esperado[n++] = (uint8_t)valores[i];
+            esperado[n++] = (uint8_t)((uint16_t)valores[i] >> 8);
+        }
+        uint8_t saida[16];
+        memset(saida, 0xEE, sizeof(saida));
+        VERIFICAR_IGUAL(registro_tamanho_empacotado(canais), n);
+        VERIFICAR_IGUAL(registro_empacotar(saida, &raw, canais), n);
+        VERIFICAR(memcmp(saida, esperado, n) == 0);
+        VERIFICAR_IGUAL(saida[n], 0xEE);
+    }
+    VERIFICAR_IGUAL(ESQUEMA_CANAIS, 7);
+}
+
+int main(void) {
+    testar_cabecalho();
+    testar_linhas();
+    testar_empacotamento();
+    return RESULTADO_TESTE();
+}
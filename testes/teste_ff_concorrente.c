@@ -0,0 +1,103 @@
+// FatFs reentrante (FF_FS_REENTRANT com as travas POSIX de ffsystem.c, o
+// OS_TYPE 6): várias threads gravam, sincronizam e listam arquivos no mesmo
+// volume ao mesmo tempo. No fim cada arquivo tem que ter exatamente o que a
+// sua thread escreveu, e os contadores de ff_mutex_stats.h têm que mostrar
+// disputa pelo volume sem nenhum timeout.
+
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include "cartao_ram.h"
+#include "ff_mutex_stats.h"
+#include "verificar.h"
+
+#define THREADS 4
+#define ESCRITAS 4000
+#define TAMANHO_ESCRITA 100 // Não divide o setor: escritas cruzam setores
+
+static FRESULT resultados[THREADS];
+
+// Conteúdo da escrita n da thread t
+static void preencher(uint8_t *bloco, int thread, int n) {
+    for (int i = 0; i < TAMANHO_ESCRITA; i++) bloco[i] = (uint8_t)(thread * 61 + n * 7 + i);
+}
+
+static void *gravar(void *argumento) {
+    int thread = (int)(intptr_t)argumento;
+    char nome[16];
+    snprintf(nome, sizeof(nome), "thread%d.bin", thread);
+    FIL arquivo;
+    FRESULT resultado = f_open(&arquivo, nome, FA_WRITE | FA_CREATE_ALWAYS);
+    for (int n = 0; resultado == FR_OK && n < ESCRITAS; n++) {
+        uint8_t bloco[TAMANHO_ESCRITA];
+        preencher(bloco, thread, n);
+        UINT escritos;
+        resultado = f_write(&arquivo, bloco, sizeof(bloco), &escritos);
+        if (resultado == FR_OK && escritos < sizeof(bloco)) resultado = FR_DENIED;
+        if (resultado == FR_OK && n % 50 == 0) resultado = f_sync(&arquivo);
+        if (resultado == FR_OK && n % 200 == 0) {
+            // Leituras do diretório no meio das escritas das outras threads
+            FILINFO info;
+            resultado = f_stat(nome, &info);
+        }
+    }
+    FRESULT resultado_fechar = f_close(&arquivo);
+    resultados[thread] = resultado != FR_OK ? resultado : resultado_fechar;
+    return NULL;
+}
+
+int main(void) {
+    VERIFICAR_IGUAL(cartao_ram_formatar(), FR_OK);
+    // Enquanto uma thread espera o cartão com o volume travado, as outras
+    // chegam ao FatFs e têm que esperar por ele
+    cartao_ram_atrasar_escritas(50);
+
+    pthread_t threads[THREADS];
+    for (int t = 0; t < THREADS; t++) {
+        pthread_create(&threads[t], NULL, gravar, (void *)(intptr_t)t);
+    }
+    for (int t = 0; t < THREADS; t++) {
+        pthread_join(threads[t], NULL);
+        VERIFICAR_IGUAL(resultados[t], FR_OK);
+    }
+
+    ff_mutex_stats_t disputa;
+    ff_mutex_get_stats(0, &disputa);
+    printf("%lu acessos, %lu esperas (max %lu us), %lu timeouts\n", (unsigned long)disputa.takes,
+           (unsigned long)disputa.contended, (unsigned long)disputa.max_wait_us,
+           (unsigned long)disputa.timeouts);
+    VERIFICAR(disputa.takes >= THREADS * ESCRITAS);
+    VERIFICAR(disputa.contended > 0);
+    VERIFICAR_IGUAL(disputa.timeouts, 0);
+
+    // Cada arquivo, lido depois de montar de novo, tem só o que a sua thread gravou
+    cartao_ram_atrasar_escritas(0);
+    cartao_ram_religar();
+    VERIFICAR_IGUAL(cartao_ram_montar(), FR_OK);
+    for (int t = 0; t < THREADS; t++) {
+        char nome[16];
+        snprintf(nome, sizeof(nome), "thread%d.bin", t);
+        FIL arquivo;
+        VERIFICAR_IGUAL(f_open(&arquivo, nome, FA_READ), FR_OK);
+        VERIFICAR_IGUAL(f_size(&arquivo), ESCRITAS * TAMANHO_ESCRITA);
+        int diferentes = 0;
+        for (int n = 0; n < ESCRITAS; n++) {
+            uint8_t lido[TAMANHO_ESCRITA], esperado[TAMANHO_ESCRITA];
+            UINT lidos;
+            preencher(esperado, t, n);
+            if (f_read(&arquivo, lido, sizeof(lido), &lidos) != FR_OK || lidos < sizeof(lido) ||
+                memcmp(lido, esperado, sizeof(lido)) != 0) {
+                diferentes++;
+            }
+        }
+        VERIFICAR_IGUAL(diferentes, 0);
+        f_close(&arquivo);
+    }
+
+    // FF_FS_LOCK: um arquivo aberto para escrita não abre de novo
+    FIL primeiro, segundo;
+    VERIFICAR_IGUAL(f_open(&primeiro, "thread0.bin", FA_WRITE), FR_OK);
+    VERIFICAR_IGUAL(f_open(&segundo, "thread0.bin", FA_WRITE), FR_LOCKED);
+    f_close(&primeiro);
+    return RESULTADO_TESTE();
+}
@@ -0,0 +1,103 @@
+// formato_decimal contra o printf: decimal_escrever_float() tem que escrever
+// o mesmo texto que "%.*f" e decimal_preencher_campo() o mesmo número com
+// zeros à esquerda, inclusive o sinal de -0.000. Os floats são percorridos
+// pelos bits com um passo; "./teste_formato_decimal completo" percorre todos
+// os floats positivos e negativos com as casas do esquema (demora minutos).
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include "formato_decimal.h"
+#include "verificar.h"
+
+// O campo sem os zeros à esquerda tem que ser o texto de decimal_escrever()
+static bool campo_equivale(const char *campo, uint8_t largura, const char *esperado) {
+    char numero[32];
+    size_t n = 0;
+    size_t i = 0;
+    if (campo[0] == '-') numero[n++] = campo[i++];
+    while (i + 1 < largura && campo[i] == '0' && campo[i + 1] != '.') i++;
+    memcpy(numero + n, campo + i, largura - i);
+    numero[n + largura - i] = '\0';
+    return strcmp(numero, esperado) == 0;
+}
+
+// Confere um valor com as casas dadas; retorna false na primeira diferença
+static bool conferir(float valor, uint8_t casas) {
+    char esperado[64], obtido[FORMATO_DECIMAL_TAMANHO_MAXIMO + 8];
+    snprintf(esperado, sizeof(esperado), "%.*f", casas, (double)valor);
+    char *fim = decimal_escrever_float(obtido, valor, casas);
+    if (strcmp(obtido, esperado) != 0 || fim != obtido + strlen(obtido)) {
+        printf("%.9g com %u casas: \"%s\", printf \"%s\"\n", (double)valor, casas, obtido,
+               esperado);
+        return false;
+    }
+
+    // Campo com um dígito a mais que o necessário, já com o ponto no lugar
+    uint8_t largura = (uint8_t)strlen(esperado) + 1;
+    char campo[32];
+    memset(campo, '0', largura);
+    if (casas) campo[largura - casas - 1] = '.';
+    bool negativo;
+    uint32_t magnitude = decimal_escalar(valor, casas, &negativo);
+    decimal_preencher_campo(campo, largura, casas, magnitude, negativo);
+    if (!campo_equivale(campo, largura, esperado)) {
+        printf("%.9g com %u casas: campo \"%.*s\", printf \"%s\"\n", (double)valor, casas,
+               largura, campo, esperado);
+        return false;
+    }
+    return true;
+}
+
+// Percorre os floats finitos de 0 até o limite da escala, com o passo dado
+static void percorrer(uint8_t casas, uint32_t passo) {
+    double limite = 4294967295.0;
+    for (uint8_t i = 0; i < casas; i++) limite /= 10;
+    int diferencas = 0;
+    for (uint64_t bits = 0; bits < 0x7F800000u && diferencas < 10; bits += passo) {
+        union { uint32_t u; float f; } v = {.u = (uint32_t)bits};
+        if (v.f >= limite) break;
+        if (!conferir(v.f, casas)) diferencas++;
+        if (!conferir(-v.f, casas)) diferencas++;
+    }
+    VERIFICAR_IGUAL(diferencas, 0);
+}
+
+int main(int argc, char **argv) {
+    bool completo = argc > 1 && strcmp(argv[1], "completo") == 0;
+
+    // Casos conhecidos: metade para o par, -0.000 e saturação do campo
+    VERIFICAR(conferir(0.0005f, 3));
+    VERIFICAR(conferir(-0.0004f, 3));
+    VERIFICAR(conferir(-0.0f, 3));
+    VERIFICAR(conferir(2.5f, 0));
+    VERIFICAR(conferir(9.81f, 3));
+    VERIFICAR(conferir(-24.0f, 2));
+    char texto[FORMATO_DECIMAL_TAMANHO_MAXIMO + 8];
+    decimal_escrever_float(texto, -INFINITY, 3);
+    VERIFICAR(strcmp(texto, "-inf") == 0);
+    decimal_escrever_float(texto, NAN, 3);
+    VERIFICAR(strcmp(texto, "nan") == 0);
+
+    char campo[] = "000.000";
+    bool negativo;
+    uint32_t magnitude = decimal_escalar(-0.0004f, 3, &negativo);
+    decimal_preencher_campo(campo, 7, 3, magnitude, negativo);
+    VERIFICAR(strcmp(campo, "-00.000") == 0);
+    magnitude = decimal_escalar(1234.5f, 3, &negativo);
+    decimal_preencher_campo(campo, 7, 3, magnitude, negativo);
+    VERIFICAR(strcmp(campo, "999.999") == 0);
+    magnitude = decimal_escalar(-1234.5f, 3, &negativo);
+    decimal_preencher_campo(campo, 7, 3, magnitude, negativo);
+    VERIFICAR(strcmp(campo, "-99.999") == 0);
+
+    if (completo) {
+        percorrer(3, 1);
+        percorrer(2, 1);
+    } else {
+        for (uint8_t casas = 0; casas <= FORMATO_DECIMAL_CASAS_MAXIMAS; casas++) {
+            percorrer(casas, 9973);
+        }
+    }
+    return RESULTADO_TESTE();
+}
@@ -0,0 +1,114 @@
+// Preparação dos arquivos da rotação: a reserva tem o tamanho pedido (sem
+// arredondar para a AU do cartão) e começa em um limite de AU, os dois
+// primeiros arquivos ficam prontos em log_abrir() e, durante a gravação, nenhum apagamento passa de
+// LOG_SETORES_POR_APAGAMENTO setores. Apagamentos que falham são contados.
+// f_trim(), que apaga a reserva, trava o volume como o resto do FatFs.
+
+#include <stdio.h>
+#include <string.h>
+#include "cartao_ram.h"
+#include "ff_mutex_stats.h"
+#include "log_rotativo.h"
+#include "verificar.h"
+
+#define CABECALHO "Amostra,Valor\n"
+#define TAMANHO_ARQUIVO (200 * 1024) // 400 setores: dois passos de apagamento
+#define LINHAS 30000
+
+static const config_log_t config = {
+    .prefixo = "teste_",
+    .extensao = ".csv",
+    .cabecalho = CABECALHO,
+    .tamanho_maximo = TAMANHO_ARQUIVO,
+    .tamanho_prealocado = TAMANHO_ARQUIVO,
+    .apagar_reserva = true,
+    .checkpoint = "teste.chk",
+};
+static log_rotativo_t log;
+
+// Grava linhas como o firmware: a preparação avança entre uma e outra
+static void gravar_linhas(uint32_t primeira, uint32_t quantidade) {
+    for (uint32_t amostra = primeira; amostra < primeira + quantidade; amostra++) {
+        char linha[64];
+        int tamanho = snprintf(linha, sizeof(linha), "%lu,%lu.123456789\n",
+                               (unsigned long)amostra, (unsigned long)amostra * 7);
+        VERIFICAR_IGUAL(log_escrever(&log, linha, tamanho), FR_OK);
+        if (amostra % 20 == 0) VERIFICAR_IGUAL(log_checkpoint(&log, amostra), FR_OK);
+        VERIFICAR_IGUAL(log_preparar_proximo(&log), FR_OK);
+    }
+}
+
+int main(void) {
+    VERIFICAR_IGUAL(cartao_ram_formatar(), FR_OK);
+
+    VERIFICAR_IGUAL(log_abrir(&log, &config), FR_OK);
+    VERIFICAR(log.proximo_pronto);
+    FILINFO info;
+    VERIFICAR_IGUAL(f_stat(log.nome_proximo, &info), FR_OK);
+    VERIFICAR_IGUAL(info.fsize, TAMANHO_ARQUIVO);
+    estatisticas_cartao_t cartao;
+    cartao_ram_obter_estatisticas(&cartao);
+    VERIFICAR(cartao.setores_apagados >= 2 * TAMANHO_ARQUIVO / 512);
+
+    cartao_ram_zerar_estatisticas();
+    gravar_linhas(1, LINHAS);
+    uint32_t trocas = log.indice - 1;
+    cartao_ram_obter_estatisticas(&cartao);
+    printf("%lu trocas de arquivo, %lu apagamentos, o maior de %lu setores\n",
+           (unsigned long)trocas, (unsigned long)cartao.apagamentos,
+           (unsigned long)cartao.maior_apagamento);
+    VERIFICAR(trocas >= 2);
+    VERIFICAR(cartao.maior_apagamento <= LOG_SETORES_POR_APAGAMENTO);
+    VERIFICAR(cartao.setores_apagados >= trocas * TAMANHO_ARQUIVO / 512);
+    VERIFICAR_IGUAL(log.falhas_apagamento, 0);
+    VERIFICAR_IGUAL(log.setores_au, CARTAO_RAM_AU);
+    VERIFICAR_IGUAL(log.reservas_desalinhadas, 0);
+    uint32_t ultimo = log.indice;
+    VERIFICAR_IGUAL(log_fechar(&log), FR_OK);
+
+    // Cada arquivo começa com o cabeçalho e ficou dentro do limite; o próximo
+    // que não chegou a ser usado foi apagado
+    for (uint32_t indice = 1; indice <= ultimo + 1; indice++) {
+        char nome[LOG_TAMANHO_NOME];
+        snprintf(nome, sizeof(nome), "teste_%04lu.csv", (unsigned long)indice);
+        FRESULT resultado = f_stat(nome, &info);
+        if (indice > ultimo) {
+            VERIFICAR_IGUAL(resultado, FR_NO_FILE);
+            continue;
+        }
+        VERIFICAR_IGUAL(resultado, FR_OK);
+        VERIFICAR(info.fsize <= TAMANHO_ARQUIVO);
+        FIL arquivo;
+        char inicio[sizeof(CABECALHO)] = {0};
+        UINT lidos;
+        VERIFICAR_IGUAL(f_open(&arquivo, nome, FA_READ), FR_OK);
+        VERIFICAR_IGUAL(f_read(&arquivo, inicio, sizeof(inicio) - 1, &lidos), FR_OK);
+        VERIFICAR(strcmp(inicio, CABECALHO) == 0);
+        f_close(&arquivo);
+    }
+
+    // f_trim() passa pela trava do volume e só aceita setores do arquivo
+    FIL reservado;
+    VERIFICAR_IGUAL(f_open(&reservado, "reserva.bin", FA_WRITE | FA_CREATE_NEW), FR_OK);
+    VERIFICAR_IGUAL(f_expand(&reservado, 8 * 512, 1), FR_OK);
+    ff_mutex_stats_t antes, depois;
+    ff_mutex_get_stats(0, &antes);
+    VERIFICAR_IGUAL(f_trim(&reservado, 0, 8 * 512), FR_OK);
+    ff_mutex_get_stats(0, &depois);
+    VERIFICAR_IGUAL(depois.takes - antes.takes, 1);
+    VERIFICAR_IGUAL(f_trim(&reservado, 512, 8 * 512), FR_INVALID_PARAMETER);
+    VERIFICAR_IGUAL(f_trim(&reservado, 100, 512), FR_INVALID_PARAMETER);
+    f_close(&reservado);
+    f_unlink("reserva.bin");
+
+    // O cartão recusa os apagamentos: a sessão grava assim mesmo e conta as falhas
+    cartao_ram_falhar_apagamentos(true);
+    VERIFICAR_IGUAL(log_abrir(&log, &config), FR_OK);
+    VERIFICAR_IGUAL(log.falhas_apagamento, 2);
+    gravar_linhas(1, LINHAS / 2);
+    VERIFICAR(log.falhas_apagamento > 2);
+    VERIFICAR_IGUAL(log_fechar(&log), FR_OK);
+    cartao_ram_falhar_apagamentos(false);
+
+    return RESULTADO_TESTE();
+}
@@ -0,0 +1,108 @@
+// Leitura por grupos do mpu6050 com um sensor simulado no I2C: para cada
+// combinação de canais, uma única rajada do primeiro ao último grupo pedido
+// (com aceleração e giroscópio, os 14 bytes), os campos pedidos na ordem dos
+// registradores e os outros intactos.
+
+#include <string.h>
+#include "mpu6050.h"
+#include "verificar.h"
+
+#define ENDERECO_MPU6050 0x68
+#define REG_ACCEL_XOUT_H 0x3B
+#define SENTINELA 0x7A5A
+
+struct i2c_inst {
+    int numero;
+};
+
+// Registradores do sensor simulado a partir de ACCEL_XOUT_H
+static uint8_t registradores[14];
+static uint8_t registrador_atual;
+static int escritas_registrador, leituras;
+static size_t tamanho_lido;
+static bool manteve_barramento;
+
+int i2c_write_blocking(i2c_inst_t *i2c, uint8_t endereco, const uint8_t *dados, size_t tamanho,
+                       bool manter) {
+    (void)i2c;
+    VERIFICAR_IGUAL(endereco, ENDERECO_MPU6050);
+    registrador_atual = dados[0];
+    if (tamanho == 1) { // Só o endereço do registrador, antes de uma leitura
+        escritas_registrador++;
+        manteve_barramento = manter;
+    }
+    return (int)tamanho;
+}
+
+int i2c_read_blocking(i2c_inst_t *i2c, uint8_t endereco, uint8_t *dados, size_t tamanho,
+                      bool manter) {
+    (void)i2c;
+    (void)manter;
+    VERIFICAR_IGUAL(endereco, ENDERECO_MPU6050);
+    for (size_t i = 0; i < tamanho; i++) {
+        size_t posicao = registrador_atual - REG_ACCEL_XOUT_H + i;
+        dados[i] = posicao < sizeof(registradores) ? registradores[posicao] : 0xFF;
+    }
+    leituras++;
+    tamanho_lido = tamanho;
+    return (int)tamanho;
+}
+
+int main(void) {
+    struct i2c_inst barramento = {0};
+    mpu6050_init(&barramento);
+
+    // Valores com o byte alto e o baixo diferentes, e alguns negativos
+    static const int16_t valores[7] = {-12345, 2345, 16384, -3210, 131, -32768, 32767};
+    for (int i = 0; i < 7; i++) {
+        registradores[2 * i] = (uint8_t)((uint16_t)valores[i] >> 8);
+        registradores[2 * i + 1] = (uint8_t)valores[i];
+    }
+
+    // Bytes lidos e primeiro registrador para cada máscara de canais
+    static const size_t TAMANHO_ESPERADO[8] = {0, 6, 2, 8, 6, 14, 8, 14};
+    static const uint8_t INICIO_ESPERADO[8] = {0, 0, 6, 0, 8, 0, 6, 0};
+    // Campo de mpu6050_raw_t -> grupo de canais
+    static const uint8_t GRUPO_DO_CAMPO[7] = {
+        MPU6050_CANAL_ACEL, MPU6050_CANAL_ACEL, MPU6050_CANAL_ACEL, MPU6050_CANAL_TEMP,
+        MPU6050_CANAL_GIRO, MPU6050_CANAL_GIRO, MPU6050_CANAL_GIRO,
+    };
+
+    for (uint8_t canais = 0; canais <= MPU6050_TODOS_CANAIS; canais++) {
+        mpu6050_raw_t raw;
+        int16_t *campos = (int16_t *)&raw;
+        for (int i = 0; i < 7; i++) campos[i] = SENTINELA;
+        escritas_registrador = leituras = 0;
+        tamanho_lido = 0;
+
+        mpu6050_read_raw_canais(&raw, canais);
+
+        if (canais == 0) {
+            VERIFICAR_IGUAL(escritas_registrador + leituras, 0);
+        } else {
+            VERIFICAR_IGUAL(escritas_registrador, 1);
+            VERIFICAR(manteve_barramento);
+            VERIFICAR_IGUAL(leituras, 1);
+            VERIFICAR_IGUAL(registrador_atual, REG_ACCEL_XOUT_H + INICIO_ESPERADO[canais]);
+            VERIFICAR_IGUAL(tamanho_lido, TAMANHO_ESPERADO[canais]);
+        }
+        for (int i = 0; i < 7; i++) {
+            int16_t esperado = (canais & GRUPO_DO_CAMPO[i]) ? valores[i] : (int16_t)SENTINELA;
+            VERIFICAR_IGUAL(campos[i], esperado);
+        }
+    }
+
+    // Bits fora dos grupos são ignorados
+    mpu6050_raw_t raw;
+    leituras = 0;
+    mpu6050_read_raw_canais(&raw, 0xF8);
+    VERIFICAR_IGUAL(leituras, 0);
+
+    // A leitura completa é a rajada de 14 bytes
+    memset(&raw, 0, sizeof(raw));
+    mpu6050_read_raw(&raw);
+    VERIFICAR_IGUAL(tamanho_lido, 14);
+    VERIFICAR_IGUAL(raw.temp, -3210);
+    VERIFICAR_IGUAL(raw.gyro_z, 32767);
+    return RESULTADO_TESTE();
+}